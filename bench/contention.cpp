@@ -0,0 +1,92 @@
+/**
+* Contention benchmark of the concurrent queue and stack against sx::queue
+* behind a mutex.
+*
+* Each of 1 to N threads repeatedly pushes an element and pops one, so the
+* structure stays nearly empty and every operation contends on its ends.
+*
+* usage: contention [max-threads] [ops-per-thread]
+* build: g++ -std=c++17 -O2 -pthread -Iinclude bench/contention.cpp
+*/
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include "queue.h"
+#include "mpmc_queue.h"
+#include "lock_free_stack.h"
+
+namespace
+{
+
+class locked_queue
+{
+private:
+    std::mutex m;
+    sx::queue<int> q;
+public:
+    bool try_push(int value)
+    {
+        std::lock_guard<std::mutex> lock(m);
+        q.push(value);
+        return true;
+    }
+    bool try_pop(int& value)
+    {
+        std::lock_guard<std::mutex> lock(m);
+        if (q.empty())
+            return false;
+        value = q.front();
+        q.pop();
+        return true;
+    }
+};
+
+/**
+* return: million operations (pushes and pops) per second
+*/
+template <typename Container>
+double run(Container & c, int n_threads, int n_ops)
+{
+    std::thread * threads = new std::thread [n_threads];
+    auto start = std::chrono::steady_clock::now();
+    for (int t = 0; t < n_threads; ++t)
+        threads[t] = std::thread([&c, n_ops, t] {
+            int value;
+            for (int i = 0; i < n_ops; ++i) {
+                while (!c.try_push(t))
+                    std::this_thread::yield();
+                while (!c.try_pop(value))
+                    std::this_thread::yield();
+            }
+        });
+    for (int t = 0; t < n_threads; ++t)
+        threads[t].join();
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    delete []threads;
+    return 2.0 * n_threads * n_ops / elapsed.count() / 1e6;
+}
+
+}
+
+int main(int argc, char * argv[])
+{
+    int max_threads = argc > 1 ? std::atoi(argv[1])
+        : int(std::thread::hardware_concurrency());
+    int n_ops = argc > 2 ? std::atoi(argv[2]) : 1000000;
+    if (max_threads < 1)
+        max_threads = 1;
+
+    std::cout << "threads\tmutex queue\tmpmc_queue\tlock_free_stack\t(Mops/s)\n";
+    for (int t = 1; t <= max_threads; ++t) {
+        locked_queue lq;
+        sx::mpmc_queue<int> mq(1024);
+        sx::lock_free_stack<int> ls(1024);
+        std::cout << t << '\t' << run(lq, t, n_ops)
+            << '\t' << run(mq, t, n_ops)
+            << '\t' << run(ls, t, n_ops) << std::endl;
+    }
+
+    return 0;
+}
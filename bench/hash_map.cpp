@@ -0,0 +1,104 @@
+/**
+* Benchmark of hash_map against std::unordered_map on 32-bit int keys.
+*
+* n random keys are inserted into an empty map, then looked up q times, half
+* of the lookups for keys in the map and half for keys not in it, and
+* finally all erased.
+*
+* usage: hash_map [n] [q]
+* build: g++ -std=c++17 -O2 -Iinclude bench/hash_map.cpp
+*/
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <unordered_map>
+#include "vector.h"
+#include "hash_map.h"
+
+namespace
+{
+
+// the same operations on both maps
+void insert(sx::hash_map<int, int> & m, int k, int v) { m.insert(k, v); }
+void insert(std::unordered_map<int, int> & m, int k, int v) { m.emplace(k, v); }
+int find(const sx::hash_map<int, int> & m, int k)
+{
+    const std::pair<int, int> * p = m.find(k);
+    return p ? p->second : -1;
+}
+int find(const std::unordered_map<int, int> & m, int k)
+{
+    auto it = m.find(k);
+    return it != m.end() ? it->second : -1;
+}
+
+typedef std::chrono::steady_clock steady;
+
+double ns_per_op(steady::time_point start, int ops)
+{
+    std::chrono::duration<double> elapsed = steady::now() - start;
+    return elapsed.count() * 1e9 / ops;
+}
+
+/**
+* t: nanoseconds per insert, lookup and erase
+* return: a checksum of the values found
+*/
+template <typename Map>
+long long run(const sx::vector<int> & keys, const sx::vector<int> & queries,
+              double t[3])
+{
+    Map m;
+    int n = keys.size(), q = queries.size();
+    long long checksum = 0;
+
+    steady::time_point start = steady::now();
+    for (int i = 0; i < n; ++i)
+        insert(m, keys[i], i);
+    t[0] = ns_per_op(start, n);
+
+    start = steady::now();
+    for (int i = 0; i < q; ++i)
+        checksum += find(m, queries[i]);
+    t[1] = ns_per_op(start, q);
+
+    start = steady::now();
+    for (int i = 0; i < n; ++i)
+        checksum += m.erase(keys[i]);
+    t[2] = ns_per_op(start, n);
+    return checksum;
+}
+
+}
+
+int main(int argc, char * argv[])
+{
+    int n = argc > 1 ? std::atoi(argv[1]) : 1 << 20;
+    int q = argc > 2 ? std::atoi(argv[2]) : 1 << 22;
+
+    // even keys are inserted, so odd ones miss
+    sx::vector<int> keys, queries;
+    unsigned seed = 1;
+    for (int i = 0; i < n; ++i) {
+        seed = seed * 1103515245 + 12345;
+        keys.push_back(int(seed & ~1u));
+    }
+    for (int i = 0; i < q; ++i) {
+        seed = seed * 1103515245 + 12345;
+        queries.push_back(i & 1 ? int(seed | 1) : keys[(seed >> 8) % n]);
+    }
+
+    double t[2][3];
+    long long sum[2];
+    sum[0] = run<sx::hash_map<int, int>>(keys, queries, t[0]);
+    sum[1] = run<std::unordered_map<int, int>>(keys, queries, t[1]);
+
+    const char * names[] = {"sx::hash_map", "std::unordered_map"};
+    for (int i = 0; i < 2; ++i)
+        std::cout << names[i] << "\tinsert " << t[i][0] << "\tfind " << t[i][1]
+            << "\terase " << t[i][2] << " ns/op\n";
+    if (sum[0] != sum[1])
+        std::cout << "checksums differ\n";
+
+    return 0;
+}
@@ -0,0 +1,116 @@
+/**
+* Benchmark of multi_queue: throughput and quality of the relaxed order.
+*
+* Throughput: threads alternate push and pop on a queue prefilled with n
+* random keys. Quality: keys 0 to n - 1 are pushed, then popped by all
+* threads at once, and each pop is ranked among the keys still present
+* at that moment. A strict priority queue would always pop rank 0. A pop is
+* ordered by when it was recorded, so with more threads than cores,
+* preemption between popping and recording inflates the measured error.
+*
+* usage: multi_queue [threads] [heaps-per-thread] [choices] [n]
+* build: g++ -std=c++17 -O2 -pthread -Iinclude bench/multi_queue.cpp
+*/
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <thread>
+#include "multi_queue.h"
+#include "vector.h"
+
+namespace
+{
+
+/**
+* return: million operations (pushes and pops) per second
+*/
+double throughput(int n_threads, int c, int choices, int n)
+{
+    sx::multi_queue<int> q(n_threads, c, choices);
+    for (int i = 0; i < n; ++i)
+        q.push(i * 7919 % n);
+    std::thread * threads = new std::thread [n_threads];
+    auto start = std::chrono::steady_clock::now();
+    for (int t = 0; t < n_threads; ++t)
+        threads[t] = std::thread([&q, n] {
+            int key;
+            for (int i = 0; i < n; ++i)
+                if (q.try_pop(key))
+                    q.push(key + n);
+        });
+    for (int t = 0; t < n_threads; ++t)
+        threads[t].join();
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    delete []threads;
+    return 2.0 * n_threads * n / elapsed.count() / 1e6;
+}
+
+/**
+* Rank the pops of keys 0 to n - 1 in order of the global pop count.
+*
+* mean, max: the mean and maximum rank error
+*/
+void rank_error(int n_threads, int c, int choices, int n, double & mean, int & max)
+{
+    sx::multi_queue<int> q(n_threads, c, choices);
+    for (int i = 0; i < n; ++i)
+        q.push(i);
+    // popped[i] is the key of the i-th pop overall
+    sx::vector<int> popped(n);
+    std::atomic<int> count(0);
+    std::thread * threads = new std::thread [n_threads];
+    for (int t = 0; t < n_threads; ++t)
+        threads[t] = std::thread([&q, &popped, &count] {
+            int key;
+            while (q.try_pop(key))
+                popped[count.fetch_add(1)] = key;
+        });
+    for (int t = 0; t < n_threads; ++t)
+        threads[t].join();
+    delete []threads;
+
+    // a Fenwick tree over keys counts those still present below a key
+    sx::vector<int> tree(n + 1);
+    for (int i = 1; i <= n; ++i)
+        tree[i] = 0;
+    for (int i = 1; i <= n; ++i)
+        for (int j = i; j <= n; j += j & -j)
+            ++tree[j];
+    long long sum = 0;
+    max = 0;
+    for (int i = 0; i < n; ++i) {
+        int rank = 0;
+        for (int j = popped[i]; j > 0; j -= j & -j)
+            rank += tree[j];
+        for (int j = popped[i] + 1; j <= n; j += j & -j)
+            --tree[j];
+        sum += rank;
+        if (rank > max)
+            max = rank;
+    }
+    mean = double(sum) / n;
+}
+
+}
+
+int main(int argc, char * argv[])
+{
+    int n_threads = argc > 1 ? std::atoi(argv[1])
+        : int(std::thread::hardware_concurrency());
+    int c = argc > 2 ? std::atoi(argv[2]) : 2;
+    int choices = argc > 3 ? std::atoi(argv[3]) : 2;
+    int n = argc > 4 ? std::atoi(argv[4]) : 1000000;
+    if (n_threads < 1)
+        n_threads = 1;
+
+    double mean;
+    int max;
+    rank_error(n_threads, c, choices, n, mean, max);
+    std::cout << "threads " << n_threads << ", heaps per thread " << c
+        << ", choices " << choices << '\n'
+        << "throughput\t" << throughput(n_threads, c, choices, n) << " Mops/s\n"
+        << "rank error\tmean " << mean << ", max " << max << std::endl;
+
+    return 0;
+}
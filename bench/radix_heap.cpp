@@ -0,0 +1,65 @@
+/**
+* Benchmark of radix_heap against min_heap on a monotone workload.
+*
+* Like Dijkstra's algorithm or an event simulation, the heap is filled with
+* n keys and every step pops the minimum key k and pushes k + d for a random
+* d < C, keeping the heap at n keys.
+*
+* usage: radix_heap [steps] [n] [C]
+* build: g++ -std=c++17 -O2 -Iinclude bench/radix_heap.cpp
+*/
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include "min_heap.h"
+#include "radix_heap.h"
+
+namespace
+{
+
+/**
+* return: nanoseconds per step, the sum of popped keys in checksum
+*/
+template <typename Heap>
+double run(int steps, int n, unsigned c, unsigned long long & checksum)
+{
+    Heap h;
+    unsigned seed = 1;
+    checksum = 0;
+    for (int i = 0; i < n; ++i) {
+        seed = seed * 1103515245 + 12345;
+        h.push((seed >> 8) % c);
+    }
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < steps; ++i) {
+        unsigned k = h.top();
+        h.pop();
+        checksum += k;
+        seed = seed * 1103515245 + 12345;
+        h.push(k + (seed >> 8) % c);
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count() * 1e9 / steps;
+}
+
+}
+
+int main(int argc, char * argv[])
+{
+    int steps = argc > 1 ? std::atoi(argv[1]) : 10000000;
+    int n = argc > 2 ? std::atoi(argv[2]) : 1 << 16;
+    unsigned c = argc > 3 ? unsigned(std::atol(argv[3])) : 1u << 20;
+    unsigned long long sum[3];
+
+    double t_radix = run<sx::radix_heap<unsigned>>(steps, n, c, sum[0]);
+    double t_binary = run<sx::min_heap<unsigned>>(steps, n, c, sum[1]);
+    double t_4ary = run<sx::min_heap<unsigned, 4>>(steps, n, c, sum[2]);
+    std::cout << "radix_heap\t" << t_radix << " ns/step\n"
+        << "min_heap<2>\t" << t_binary << " ns/step\n"
+        << "min_heap<4>\t" << t_4ary << " ns/step\n";
+    // all heaps must pop the same keys
+    if (sum[0] != sum[1] || sum[0] != sum[2])
+        std::cout << "checksums differ\n";
+
+    return 0;
+}
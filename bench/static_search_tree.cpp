@@ -0,0 +1,109 @@
+/**
+* Benchmark of lower_bound on the static search trees against binary search
+* on the sorted array and a pointer-based search tree (std::set).
+*
+* n random ints are searched for q random values, one at a time and, for
+* the static trees, through the batch lookup.
+*
+* usage: static_search_tree [n] [q]
+* build: g++ -std=c++17 -O2 -Iinclude bench/static_search_tree.cpp
+*/
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <set>
+#include "vector.h"
+#include "static_search_tree.h"
+
+namespace
+{
+
+/**
+* return: nanoseconds per query of f(i) for i in [0, q), adding what f
+* returns to checksum
+*/
+template <typename F>
+double run(int q, F f, long long & checksum)
+{
+    checksum = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < q; ++i)
+        checksum += f(i);
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count() * 1e9 / q;
+}
+
+template <typename Tree>
+double run_batch(const Tree & t, const sx::vector<int> & queries,
+                 long long & checksum)
+{
+    const int BATCH = 256;
+    const int * out[BATCH];
+    int q = queries.size();
+    checksum = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < q; i += BATCH) {
+        int n = q - i < BATCH ? q - i : BATCH;
+        t.lower_bound(&queries[i], n, out);
+        for (int j = 0; j < n; ++j)
+            checksum += out[j] ? *out[j] : -1;
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count() * 1e9 / q;
+}
+
+}
+
+int main(int argc, char * argv[])
+{
+    int n = argc > 1 ? std::atoi(argv[1]) : 1 << 22;
+    int q = argc > 2 ? std::atoi(argv[2]) : 1 << 22;
+
+    sx::vector<int> keys, queries;
+    unsigned seed = 1;
+    for (int i = 0; i < n; ++i) {
+        seed = seed * 1103515245 + 12345;
+        keys.push_back(int(seed >> 1));
+    }
+    std::sort(keys.begin(), keys.end());
+    for (int i = 0; i < q; ++i) {
+        seed = seed * 1103515245 + 12345;
+        queries.push_back(int(seed >> 1));
+    }
+    std::set<int> set(keys.begin(), keys.end());
+    sx::eytzinger_tree<int> eytzinger(keys);
+    sx::veb_tree<int> veb(keys);
+
+    long long sum[6];
+    double t[6];
+    t[0] = run(q, [&](int i) {
+        const int * p = std::lower_bound(keys.begin(), keys.end(), queries[i]);
+        return p != keys.end() ? *p : -1;
+    }, sum[0]);
+    t[1] = run(q, [&](int i) {
+        auto it = set.lower_bound(queries[i]);
+        return it != set.end() ? *it : -1;
+    }, sum[1]);
+    t[2] = run(q, [&](int i) {
+        const int * p = eytzinger.lower_bound(queries[i]);
+        return p ? *p : -1;
+    }, sum[2]);
+    t[3] = run_batch(eytzinger, queries, sum[3]);
+    t[4] = run(q, [&](int i) {
+        const int * p = veb.lower_bound(queries[i]);
+        return p ? *p : -1;
+    }, sum[4]);
+    t[5] = run_batch(veb, queries, sum[5]);
+
+    const char * names[] = {"std::lower_bound", "std::set", "eytzinger",
+        "eytzinger batch", "veb", "veb batch"};
+    for (int i = 0; i < 6; ++i)
+        std::cout << names[i] << '\t' << t[i] << " ns/query\n";
+    // all searches must find the same keys
+    for (int i = 1; i < 6; ++i)
+        if (sum[i] != sum[0])
+            std::cout << names[i] << ": checksum differs\n";
+
+    return 0;
+}
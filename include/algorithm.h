@@ -13,27 +13,36 @@ namespace sx
  *         swap a[i] and a[j]
  *         increment i
  * swap a[i] and x
- * quick sort on the rest of the array
+ * return i
+ */
+template <typename RandomIt>
+RandomIt partition(RandomIt first, RandomIt last)
+{
+    auto p = *(last - 1);
+    RandomIt i = first;
+    decltype(p) temp;
+    
+    for (RandomIt j = first; j < last - 1; ++j)
+        if (*j <= p) {
+            // swap i and j
+            temp = *i;
+            *i = *j;
+            *j = temp;
+            ++i;
+        }
+    *(last - 1) = *i;
+    *i = p;
+    return i;
+}
+
+/*
+ * partition the array and quick sort on the rest of the array
  */
 template <typename RandomIt>
 void quick_sort(RandomIt first, RandomIt last)
 {
     if (first < last) {
-        auto p = *(last - 1);
-        RandomIt i = first;
-        decltype(p) temp;
-        
-        for (RandomIt j = first; j < last - 1; ++j)
-            if (*j <= p) {
-                // swap i and j
-                temp = *i;
-                *i = *j;
-                *j = temp;
-                ++i;
-            }
-        *(last - 1) = *i;
-        *i = p;
-        
+        RandomIt i = partition(first, last);
         quick_sort(first, i);
         quick_sort(i + 1, last);
     }
@@ -0,0 +1,329 @@
+#ifndef AVL_TREE_H_
+#define AVL_TREE_H_
+
+#include "linked_binary_tree.h"
+#include "object_pool.h"
+
+namespace sx
+{
+
+/**
+* A sorted multiset as an AVL tree on the nodes of linked_binary_tree, for
+* sorted data that changes, where vector::insert and erase would shift
+* O(n) elements.
+*
+* Every node also records the height and the number of nodes of its subtree.
+* Heights keep the tree balanced, and sizes answer select(k) (the k-th least
+* key) and rank(value) in O(log n), as needed by e.g. Josephus elimination.
+* Nodes come from an object_pool owned by the tree.
+*/
+template <typename T>
+class avl_tree : public linked_binary_tree<T>
+{
+private:
+    typedef typename linked_binary_tree<T>::node node;
+    struct avl_node : node
+    {
+        int height, size;
+
+        avl_node(const T& key_) noexcept : node(key_), height(1), size(1) {}
+    };
+
+    object_pool<avl_node> pool;
+
+    static int height(const node * n) noexcept
+    {
+        return n ? static_cast<const avl_node *>(n)->height : 0;
+    }
+    static int size(const node * n) noexcept
+    {
+        return n ? static_cast<const avl_node *>(n)->size : 0;
+    }
+    // recompute the height and size of n from its children
+    static void update(node * n) noexcept
+    {
+        int l = height(n->left), r = height(n->right);
+        static_cast<avl_node *>(n)->height = 1 + (l > r ? l : r);
+        static_cast<avl_node *>(n)->size = 1 + size(n->left) + size(n->right);
+    }
+    // make c take the place of n under the parent of n
+    void replace(node * n, node * c) noexcept;
+    void rotate_left(node * n) noexcept;
+    void rotate_right(node * n) noexcept;
+    // restore balance, heights and sizes from n up to the root
+    void rebalance(node * n) noexcept;
+    // build a perfectly balanced tree of keys [first, first + n)
+    template <typename RandomIt>
+    node * build(RandomIt first, int n, node * parent);
+public:
+    class const_iterator
+    {
+    private:
+        const node * p;
+    public:
+        const_iterator(const node * p_ = nullptr) noexcept : p(p_) {}
+
+        const T& operator*() const noexcept { return p->key; }
+        // the next node in an inorder walk
+        const_iterator & operator++() noexcept;
+        bool operator==(const const_iterator & i) const noexcept { return p == i.p; }
+        bool operator!=(const const_iterator & i) const noexcept { return p != i.p; }
+    };
+
+    avl_tree() noexcept : linked_binary_tree<T>(nullptr) {}
+    /**
+    * first, last: keys in ascending order, built into a perfectly balanced
+    * tree in O(n)
+    */
+    template <typename RandomIt>
+    avl_tree(RandomIt first, RandomIt last) : linked_binary_tree<T>(nullptr)
+    {
+        this->root = build(first, last - first, nullptr);
+    }
+    avl_tree(const avl_tree &) = delete;
+    avl_tree & operator=(const avl_tree &) = delete;
+    ~avl_tree();
+
+    int size() const noexcept { return size(this->root); }
+    bool empty() const noexcept { return !this->root; }
+    const_iterator begin() const noexcept;
+    const_iterator end() const noexcept { return const_iterator(); }
+
+    void insert(const T& value);
+    /**
+    * Erase one key equal to value.
+    *
+    * return: false if there is none
+    */
+    bool erase(const T& value);
+    /**
+    * Erase the k-th least key, counting from 0.
+    */
+    void erase_at(int k) noexcept;
+    bool contains(const T& value) const noexcept;
+    /**
+    * return: the k-th least key, counting from 0
+    */
+    const T& select(int k) const noexcept;
+    /**
+    * return: the number of keys less than value
+    */
+    int rank(const T& value) const noexcept;
+private:
+    node * find_at(int k) const noexcept;
+    void erase(node * n) noexcept;
+};
+
+template <typename T>
+typename avl_tree<T>::const_iterator & avl_tree<T>::const_iterator::operator++() noexcept
+{
+    if (p->right)
+        for (p = p->right; p->left; p = p->left);
+    else {
+        // climb until coming up from a left child
+        const node * from;
+        do {
+            from = p;
+            p = p->p;
+        } while (p && p->right == from);
+    }
+    return *this;
+}
+
+template <typename T>
+typename avl_tree<T>::const_iterator avl_tree<T>::begin() const noexcept
+{
+    const node * n = this->root;
+    if (n)
+        for (; n->left; n = n->left);
+    return n;
+}
+
+template <typename T>
+avl_tree<T>::~avl_tree()
+{
+    // a postorder walk leaves a node only after its subtrees
+    for (auto i = this->begin_post(); i != this->end_post(); ) {
+        node * n = *i;
+        ++i;
+        pool.destroy(static_cast<avl_node *>(n));
+    }
+}
+
+template <typename T>
+void avl_tree<T>::replace(node * n, node * c) noexcept
+{
+    if (c)
+        c->p = n->p;
+    if (!n->p)
+        this->root = c;
+    else if (n->p->left == n)
+        n->p->left = c;
+    else
+        n->p->right = c;
+}
+
+template <typename T>
+void avl_tree<T>::rotate_left(node * n) noexcept
+{
+    node * r = n->right;
+    n->right = r->left;
+    if (r->left)
+        r->left->p = n;
+    replace(n, r);
+    r->left = n;
+    n->p = r;
+    update(n);
+    update(r);
+}
+
+template <typename T>
+void avl_tree<T>::rotate_right(node * n) noexcept
+{
+    node * l = n->left;
+    n->left = l->right;
+    if (l->right)
+        l->right->p = n;
+    replace(n, l);
+    l->right = n;
+    n->p = l;
+    update(n);
+    update(l);
+}
+
+template <typename T>
+void avl_tree<T>::rebalance(node * n) noexcept
+{
+    while (n) {
+        update(n);
+        int balance = height(n->left) - height(n->right);
+        if (balance > 1) {
+            if (height(n->left->left) < height(n->left->right))
+                rotate_left(n->left);
+            rotate_right(n);
+            // n went down, its place taken by its former left child
+            n = n->p;
+        }
+        else if (balance < -1) {
+            if (height(n->right->right) < height(n->right->left))
+                rotate_right(n->right);
+            rotate_left(n);
+            n = n->p;
+        }
+        n = n->p;
+    }
+}
+
+template <typename T>
+    template <typename RandomIt>
+typename avl_tree<T>::node * avl_tree<T>::build(RandomIt first, int n, node * parent)
+{
+    if (!n)
+        return nullptr;
+    int mid = n / 2;
+    node * root = pool.create(first[mid]);
+    root->p = parent;
+    root->left = build(first, mid, root);
+    root->right = build(first + mid + 1, n - mid - 1, root);
+    update(root);
+    return root;
+}
+
+template <typename T>
+void avl_tree<T>::insert(const T& value)
+{
+    node * parent = nullptr, ** link = &this->root;
+    while (*link) {
+        parent = *link;
+        link = value < parent->key ? &parent->left : &parent->right;
+    }
+    *link = pool.create(value);
+    (*link)->p = parent;
+    rebalance(parent);
+}
+
+template <typename T>
+void avl_tree<T>::erase(node * n) noexcept
+{
+    if (n->left && n->right) {
+        // take the key of the successor, which has no left child, and erase
+        // the successor instead
+        node * s;
+        for (s = n->right; s->left; s = s->left);
+        n->key = s->key;
+        n = s;
+    }
+    node * parent = n->p;
+    replace(n, n->left ? n->left : n->right);
+    pool.destroy(static_cast<avl_node *>(n));
+    rebalance(parent);
+}
+
+template <typename T>
+bool avl_tree<T>::erase(const T& value)
+{
+    node * n = this->root;
+    while (n && (n->key < value || value < n->key))
+        n = value < n->key ? n->left : n->right;
+    if (!n)
+        return false;
+    erase(n);
+    return true;
+}
+
+template <typename T>
+void avl_tree<T>::erase_at(int k) noexcept
+{
+    erase(find_at(k));
+}
+
+template <typename T>
+bool avl_tree<T>::contains(const T& value) const noexcept
+{
+    const node * n = this->root;
+    while (n && (n->key < value || value < n->key))
+        n = value < n->key ? n->left : n->right;
+    return n;
+}
+
+template <typename T>
+typename avl_tree<T>::node * avl_tree<T>::find_at(int k) const noexcept
+{
+    // assume 0 <= k < size()
+    node * n = this->root;
+    while (true) {
+        int l = size(n->left);
+        if (k < l)
+            n = n->left;
+        else if (k > l) {
+            k -= l + 1;
+            n = n->right;
+        }
+        else
+            return n;
+    }
+}
+
+template <typename T>
+const T& avl_tree<T>::select(int k) const noexcept
+{
+    return find_at(k)->key;
+}
+
+template <typename T>
+int avl_tree<T>::rank(const T& value) const noexcept
+{
+    int r = 0;
+    for (const node * n = this->root; n; )
+        if (n->key < value) {
+            r += size(n->left) + 1;
+            n = n->right;
+        }
+        else
+            n = n->left;
+    return r;
+}
+
+}
+
+#endif // AVL_TREE_H_
@@ -0,0 +1,160 @@
+#ifndef CHUNKED_ARRAY_H_
+#define CHUNKED_ARRAY_H_
+
+#include <new>
+#include <utility>
+
+namespace sx
+{
+
+/**
+* A stack-like container built from a linked chain of arrays, each twice as
+* large as the previous one. Unlike vector, growing never moves elements, and
+* unlike rforward_list, a push only allocates when all chunks are full.
+*
+* Chunks are kept after the elements in them have been popped, so pushes and
+* pops oscillating around a chunk boundary never reach the allocator. All
+* chunks are freed in the destructor.
+*/
+template <typename T>
+class chunked_array
+{
+private:
+    struct chunk
+    {
+        T * data;
+        int capacity;
+        chunk * prev, * next;
+    };
+    static const int MIN_CAPACITY = 16;
+
+    int var_size;
+    // the total capacity of all chunks in the chain
+    int var_capacity;
+    chunk * head, * cur;
+    // number of elements in the chunk cur
+    int top;
+
+    chunk * append_chunk(int capacity);
+public:
+    chunked_array() noexcept
+        : var_size(0), var_capacity(0), head(nullptr), cur(nullptr), top(0) {}
+    chunked_array(const chunked_array & a);
+    chunked_array & operator=(const chunked_array &) = delete;
+    ~chunked_array();
+
+    int size() const noexcept { return var_size; }
+    int capacity() const noexcept { return var_capacity; }
+    bool empty() const noexcept { return !var_size; }
+    T& back() noexcept { return cur->data[top - 1]; }
+    const T& back() const noexcept { return cur->data[top - 1]; }
+    void push_back(const T& value);
+    void push_back(T&& value);
+    void pop_back();
+
+    /**
+    * Make room for at least n elements so that the first n pushes do not
+    * allocate, e.g. with n being the expected height of a tree walked with a
+    * stack.
+    */
+    void reserve(int n);
+};
+
+template <typename T>
+typename chunked_array<T>::chunk * chunked_array<T>::append_chunk(int capacity)
+{
+    chunk * c = new chunk {
+        static_cast<T *>(::operator new(capacity * sizeof(T))),
+        capacity, nullptr, nullptr
+    };
+    if (head) {
+        chunk * last = cur;
+        while (last->next)
+            last = last->next;
+        c->prev = last;
+        last->next = c;
+    }
+    else
+        head = cur = c;
+    var_capacity += capacity;
+    return c;
+}
+
+template <typename T>
+chunked_array<T>::chunked_array(const chunked_array & a) : chunked_array()
+{
+    if (a.empty())
+        return;
+    reserve(a.var_size);
+    // copy chunk by chunk from the bottom of the stack
+    for (const chunk * c = a.head; ; c = c->next) {
+        int n = c == a.cur ? a.top : c->capacity;
+        for (int i = 0; i < n; ++i)
+            push_back(c->data[i]);
+        if (c == a.cur)
+            break;
+    }
+}
+
+template <typename T>
+chunked_array<T>::~chunked_array()
+{
+    while (!empty())
+        pop_back();
+    chunk * temp;
+    while (head) {
+        temp = head;
+        head = head->next;
+        ::operator delete(temp->data);
+        delete temp;
+    }
+}
+
+template <typename T>
+void chunked_array<T>::push_back(const T& value)
+{
+    T temp(value);
+    push_back(std::move(temp));
+}
+
+template <typename T>
+void chunked_array<T>::push_back(T&& value)
+{
+    if (!cur)
+        append_chunk(MIN_CAPACITY);
+    else if (top == cur->capacity) {
+        // reuse a chunk kept from earlier pops or grow geometrically
+        cur = cur->next ? cur->next : append_chunk(2 * cur->capacity);
+        top = 0;
+    }
+    new (cur->data + top) T(std::move(value));
+    ++top;
+    ++var_size;
+}
+
+template <typename T>
+void chunked_array<T>::pop_back()
+{
+    if (!empty()) {
+        cur->data[--top].~T();
+        --var_size;
+        // step back to the previous chunk, keeping the current one, so that
+        // back() is always valid on a non-empty array
+        if (top == 0 && cur->prev) {
+            cur = cur->prev;
+            top = cur->capacity;
+        }
+    }
+}
+
+template <typename T>
+void chunked_array<T>::reserve(int n)
+{
+    if (n > var_capacity)
+        append_chunk(n - var_capacity < MIN_CAPACITY ?
+            MIN_CAPACITY : n - var_capacity);
+}
+
+}
+
+#endif // CHUNKED_ARRAY_H_
@@ -0,0 +1,207 @@
+#ifndef DEQUE_H_
+#define DEQUE_H_
+
+#include <new>
+#include <utility>
+
+namespace sx
+{
+
+/**
+* A double-ended queue in fixed-size blocks, with O(1) amortized push and pop
+* at both ends and O(1) random access. It can be the Container of queue and
+* stack, e.g. for a sliding window or a 0-1 BFS.
+*
+* A central map holds pointers to the blocks, with the elements running from
+* position start of the first block in use on. Pushing past either end of the
+* map recenters the blocks in use in the map, or moves them to a map twice as
+* large, so that there is room at both ends again. Only block pointers move,
+* so references to elements stay valid until the elements are popped.
+*
+* Blocks emptied by pops are kept in the map and reused by later pushes, so
+* a queue that slides along at a steady size stops allocating.
+*/
+template <typename T>
+class deque
+{
+private:
+    static const int BLOCK = sizeof(T) < 32 ? 512 / sizeof(T) : 16;
+
+    // blocks, or nullptr for slots without one yet
+    T ** map;
+    int map_size;
+    // the position of the front in the blocks of the map
+    int start;
+    int var_size;
+
+    T& at(int pos) noexcept { return map[pos / BLOCK][pos % BLOCK]; }
+    const T& at(int pos) const noexcept { return map[pos / BLOCK][pos % BLOCK]; }
+    // the block at b, allocated if the slot has none
+    void ensure(int b)
+    {
+        if (!map[b])
+            map[b] = static_cast<T *>(::operator new(BLOCK * sizeof(T)));
+    }
+    // recenter the blocks in use, in a larger map if more than half full
+    void remap();
+public:
+    class const_iterator
+    {
+    private:
+        const deque * d;
+        int i;
+    public:
+        const_iterator(const deque * d_, int i_) noexcept : d(d_), i(i_) {}
+
+        const T& operator*() const noexcept { return d->at(d->start + i); }
+        const_iterator & operator++() noexcept
+        {
+            ++i;
+            return *this;
+        }
+        bool operator==(const const_iterator & it) const noexcept { return i == it.i; }
+        bool operator!=(const const_iterator & it) const noexcept { return i != it.i; }
+    };
+
+    class iterator
+    {
+    private:
+        deque * d;
+        int i;
+    public:
+        iterator(deque * d_, int i_) noexcept : d(d_), i(i_) {}
+
+        T& operator*() const noexcept { return d->at(d->start + i); }
+        iterator & operator++() noexcept
+        {
+            ++i;
+            return *this;
+        }
+        bool operator==(const iterator & it) const noexcept { return i == it.i; }
+        bool operator!=(const iterator & it) const noexcept { return i != it.i; }
+        operator const_iterator() const noexcept { return const_iterator(d, i); }
+    };
+
+    deque() noexcept : map(nullptr), map_size(0), start(0), var_size(0) {}
+    deque(const deque & d);
+    deque & operator=(const deque &) = delete;
+    ~deque();
+
+    int size() const noexcept { return var_size; }
+    bool empty() const noexcept { return !var_size; }
+    T& operator[](int i) noexcept { return at(start + i); }
+    const T& operator[](int i) const noexcept { return at(start + i); }
+    T& front() noexcept { return at(start); }
+    const T& front() const noexcept { return at(start); }
+    T& back() noexcept { return at(start + var_size - 1); }
+    const T& back() const noexcept { return at(start + var_size - 1); }
+    iterator begin() noexcept { return iterator(this, 0); }
+    const_iterator begin() const noexcept { return const_iterator(this, 0); }
+    iterator end() noexcept { return iterator(this, var_size); }
+    const_iterator end() const noexcept { return const_iterator(this, var_size); }
+
+    void push_back(const T& value)
+    {
+        T temp(value);
+        push_back(std::move(temp));
+    }
+    void push_back(T&& value);
+    void push_front(const T& value)
+    {
+        T temp(value);
+        push_front(std::move(temp));
+    }
+    void push_front(T&& value);
+    void pop_back() noexcept;
+    void pop_front() noexcept;
+};
+
+template <typename T>
+deque<T>::deque(const deque & d) : deque()
+{
+    for (const T& x : d)
+        push_back(x);
+}
+
+template <typename T>
+deque<T>::~deque()
+{
+    while (!empty())
+        pop_back();
+    for (int b = 0; b < map_size; ++b)
+        ::operator delete(map[b]);
+    delete []map;
+}
+
+template <typename T>
+void deque<T>::remap()
+{
+    int first = start / BLOCK;
+    int used = var_size ? (start + var_size - 1) / BLOCK - first + 1 : 1;
+    // a free slot at each end at least, and at most half the map in use so
+    // that remaps are O(1) amortized per block pushed
+    int new_size = map_size;
+    while (new_size < 2 * (used + 2))
+        new_size = new_size ? 2 * new_size : 8;
+
+    T ** new_map = new T * [new_size]();
+    int new_first = (new_size - used) / 2;
+    for (int b = 0; b < used; ++b)
+        if (first + b < map_size)
+            new_map[new_first + b] = map[first + b];
+    // spare blocks go right after the blocks in use, then right before them
+    int slot = new_first + used;
+    for (int b = 0; b < map_size; ++b)
+        if (map[b] && (b < first || b >= first + used)) {
+            if (slot == new_size)
+                slot = new_first - 1;
+            new_map[slot] = map[b];
+            slot += slot >= new_first ? 1 : -1;
+        }
+    delete []map;
+    map = new_map;
+    map_size = new_size;
+    start = new_first * BLOCK + start % BLOCK;
+}
+
+template <typename T>
+void deque<T>::push_back(T&& value)
+{
+    if (start + var_size == map_size * BLOCK)
+        remap();
+    int pos = start + var_size;
+    ensure(pos / BLOCK);
+    new (&at(pos)) T(std::move(value));
+    ++var_size;
+}
+
+template <typename T>
+void deque<T>::push_front(T&& value)
+{
+    if (!start)
+        remap();
+    ensure((start - 1) / BLOCK);
+    new (&at(start - 1)) T(std::move(value));
+    --start;
+    ++var_size;
+}
+
+template <typename T>
+void deque<T>::pop_back() noexcept
+{
+    if (!empty())
+        at(start + --var_size).~T();
+}
+
+template <typename T>
+void deque<T>::pop_front() noexcept
+{
+    if (!empty()) {
+        at(start++).~T();
+        --var_size;
+    }
+}
+
+}
+
+#endif // DEQUE_H_
@@ -0,0 +1,328 @@
+#ifndef DYNAMIC_BITSET_H_
+#define DYNAMIC_BITSET_H_
+
+#include <cstdint>
+#include "vector.h"
+#if defined(__SSE2__) || defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+namespace sx
+{
+
+/**
+* A fixed-size set of bits chosen at construction, for marks over a bounded
+* range of ints, e.g. values seen or nodes visited, in n / 8 bytes.
+*
+* Bits are packed into 64-bit words on a cache line boundary and padded to a
+* whole number of 256-bit lanes, so that AND, OR, XOR, ANDNOT and popcount
+* run 4 words at a time with AVX2, and a word at a time without it.
+*
+* count() picks the fastest path the target flags allow: AVX2 (-mavx2 or
+* -march=native on most x86 CPUs), then one popcnt per word (-mpopcnt or
+* -msse4.2), then SSE2, which every x86-64 build has. Other targets count a
+* word at a time through __builtin_popcountll, a library call per word
+* without a popcount instruction.
+*
+* With Summary, a second level keeps one bit per word telling whether the
+* word has any bit set, so that find_next skips 64 empty words per summary
+* bit when walking a sparse set. Single bit updates then also touch the
+* summary, and bulk operations rebuild it.
+*/
+template <bool Summary = false>
+class dynamic_bitset
+{
+private:
+    static const int CACHE_LINE = 64;
+    // words per 256-bit lane
+    static const int LANE = 4;
+
+    int n, n_words;
+    unsigned char * raw;
+    unsigned long long * words;
+    // bit w set if words[w] is not 0, with Summary only
+    vector<unsigned long long> summary;
+
+    void build_summary();
+    void update_summary(int w) noexcept
+    {
+        if (words[w])
+            summary[w >> 6] |= 1ULL << (w & 63);
+        else
+            summary[w >> 6] &= ~(1ULL << (w & 63));
+    }
+    // first set bit in the words from w on, or -1
+    int scan_from(int w) const noexcept;
+    // word operations, on a whole lane with AVX2
+    struct and_op
+    {
+#ifdef __AVX2__
+        __m256i operator()(__m256i x, __m256i y) const noexcept { return _mm256_and_si256(x, y); }
+#endif
+        unsigned long long operator()(unsigned long long x, unsigned long long y) const noexcept
+        {
+            return x & y;
+        }
+    };
+    struct or_op
+    {
+#ifdef __AVX2__
+        __m256i operator()(__m256i x, __m256i y) const noexcept { return _mm256_or_si256(x, y); }
+#endif
+        unsigned long long operator()(unsigned long long x, unsigned long long y) const noexcept
+        {
+            return x | y;
+        }
+    };
+    struct xor_op
+    {
+#ifdef __AVX2__
+        __m256i operator()(__m256i x, __m256i y) const noexcept { return _mm256_xor_si256(x, y); }
+#endif
+        unsigned long long operator()(unsigned long long x, unsigned long long y) const noexcept
+        {
+            return x ^ y;
+        }
+    };
+    struct and_not_op
+    {
+#ifdef __AVX2__
+        // andnot negates its first operand
+        __m256i operator()(__m256i x, __m256i y) const noexcept { return _mm256_andnot_si256(y, x); }
+#endif
+        unsigned long long operator()(unsigned long long x, unsigned long long y) const noexcept
+        {
+            return x & ~y;
+        }
+    };
+    template <typename Op>
+    void combine(const dynamic_bitset & b, Op op);
+public:
+    // n_: the number of bits, all 0 at first
+    explicit dynamic_bitset(int n_);
+    dynamic_bitset(const dynamic_bitset & b);
+    dynamic_bitset & operator=(const dynamic_bitset &) = delete;
+    ~dynamic_bitset() { delete []raw; }
+
+    int size() const noexcept { return n; }
+    bool test(int i) const noexcept { return words[i >> 6] >> (i & 63) & 1; }
+    void set(int i) noexcept
+    {
+        words[i >> 6] |= 1ULL << (i & 63);
+        if (Summary)
+            summary[i >> 12] |= 1ULL << (i >> 6 & 63);
+    }
+    void reset(int i) noexcept
+    {
+        words[i >> 6] &= ~(1ULL << (i & 63));
+        if (Summary)
+            update_summary(i >> 6);
+    }
+    /**
+    * Set the bits at all the indices given, in any order.
+    *
+    * return: the number of those bits that were 0 before, counting each
+    * once, e.g. the number of distinct indices when all bits were 0
+    */
+    int set(const vector<int> & indices) noexcept;
+    void reset() noexcept;
+
+    // the number of bits set
+    int count() const noexcept;
+    bool any() const noexcept { return find_first() >= 0; }
+    // the index of the first bit set, or -1
+    int find_first() const noexcept { return scan_from(0); }
+    // the index of the first bit set after i, or -1
+    int find_next(int i) const noexcept;
+
+    // bit i becomes the result of the operation on bit i of both sets,
+    // assumed to be of the same size
+    dynamic_bitset & operator&=(const dynamic_bitset & b);
+    dynamic_bitset & operator|=(const dynamic_bitset & b);
+    dynamic_bitset & operator^=(const dynamic_bitset & b);
+    // clear the bits set in b
+    dynamic_bitset & and_not(const dynamic_bitset & b);
+};
+
+template <bool Summary>
+dynamic_bitset<Summary>::dynamic_bitset(int n_) : n(n_)
+{
+    n_words = ((n + 63) / 64 + LANE - 1) / LANE * LANE;
+    raw = new unsigned char [n_words * sizeof(unsigned long long) + CACHE_LINE];
+    std::uintptr_t addr = reinterpret_cast<std::uintptr_t>(raw) + CACHE_LINE - 1;
+    addr -= addr % CACHE_LINE;
+    words = reinterpret_cast<unsigned long long *>(addr);
+    for (int w = 0; w < n_words; ++w)
+        words[w] = 0;
+    if (Summary)
+        for (int i = 0; i < (n_words + 63) / 64; ++i)
+            summary.push_back(0);
+}
+
+template <bool Summary>
+dynamic_bitset<Summary>::dynamic_bitset(const dynamic_bitset & b)
+    : dynamic_bitset(b.n)
+{
+    for (int w = 0; w < n_words; ++w)
+        words[w] = b.words[w];
+    summary = b.summary;
+}
+
+template <bool Summary>
+void dynamic_bitset<Summary>::build_summary()
+{
+    for (int w = 0; w < n_words; ++w)
+        update_summary(w);
+}
+
+template <bool Summary>
+int dynamic_bitset<Summary>::set(const vector<int> & indices) noexcept
+{
+    int added = 0;
+    for (int i : indices) {
+        unsigned long long & w = words[i >> 6], bit = 1ULL << (i & 63);
+        added += !(w & bit);
+        w |= bit;
+    }
+    if (Summary)
+        for (int i : indices)
+            summary[i >> 12] |= 1ULL << (i >> 6 & 63);
+    return added;
+}
+
+template <bool Summary>
+void dynamic_bitset<Summary>::reset() noexcept
+{
+    for (int w = 0; w < n_words; ++w)
+        words[w] = 0;
+    for (unsigned long long & s : summary)
+        s = 0;
+}
+
+template <bool Summary>
+int dynamic_bitset<Summary>::count() const noexcept
+{
+    int w = 0;
+    long long c = 0;
+#ifdef __AVX2__
+    // popcount of each nibble by table lookup, summed per 64-bit lane by
+    // psadbw (W. Mula's method)
+    const __m256i table = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+                                           0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+    const __m256i low = _mm256_set1_epi8(0x0f);
+    __m256i sum = _mm256_setzero_si256();
+    for (; w < n_words; w += LANE) {
+        __m256i v = _mm256_load_si256(reinterpret_cast<const __m256i *>(words + w));
+        __m256i bytes = _mm256_add_epi8(
+            _mm256_shuffle_epi8(table, _mm256_and_si256(v, low)),
+            _mm256_shuffle_epi8(table, _mm256_and_si256(_mm256_srli_epi16(v, 4), low)));
+        sum = _mm256_add_epi64(sum, _mm256_sad_epu8(bytes, _mm256_setzero_si256()));
+    }
+    c = _mm256_extract_epi64(sum, 0) + _mm256_extract_epi64(sum, 1)
+        + _mm256_extract_epi64(sum, 2) + _mm256_extract_epi64(sum, 3);
+#elif defined(__SSE2__) && !defined(__POPCNT__)
+    // without popcnt, the bits of each byte are added up in parallel, then
+    // summed per 64-bit lane by psadbw
+    const __m128i m1 = _mm_set1_epi8(0x55), m2 = _mm_set1_epi8(0x33),
+        m4 = _mm_set1_epi8(0x0f);
+    __m128i sum = _mm_setzero_si128();
+    for (; w < n_words; w += 2) {
+        __m128i v = _mm_load_si128(reinterpret_cast<const __m128i *>(words + w));
+        v = _mm_sub_epi8(v, _mm_and_si128(_mm_srli_epi16(v, 1), m1));
+        v = _mm_add_epi8(_mm_and_si128(v, m2), _mm_and_si128(_mm_srli_epi16(v, 2), m2));
+        v = _mm_and_si128(_mm_add_epi8(v, _mm_srli_epi16(v, 4)), m4);
+        sum = _mm_add_epi64(sum, _mm_sad_epu8(v, _mm_setzero_si128()));
+    }
+    long long lanes[2];
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(lanes), sum);
+    c = lanes[0] + lanes[1];
+#endif
+    for (; w < n_words; ++w)
+        c += __builtin_popcountll(words[w]);
+    return int(c);
+}
+
+template <bool Summary>
+int dynamic_bitset<Summary>::scan_from(int w) const noexcept
+{
+    if (Summary) {
+        // the first word from w on with a summary bit
+        int s = w >> 6;
+        if (s >= summary.size())
+            return -1;
+        unsigned long long bits = summary[s] & ~0ULL << (w & 63);
+        while (!bits) {
+            if (++s == summary.size())
+                return -1;
+            bits = summary[s];
+        }
+        w = s * 64 + __builtin_ctzll(bits);
+        return w * 64 + __builtin_ctzll(words[w]);
+    }
+    for (; w < n_words; ++w)
+        if (words[w])
+            return w * 64 + __builtin_ctzll(words[w]);
+    return -1;
+}
+
+template <bool Summary>
+int dynamic_bitset<Summary>::find_next(int i) const noexcept
+{
+    ++i;
+    if (i >= n)
+        return -1;
+    unsigned long long rest = words[i >> 6] & ~0ULL << (i & 63);
+    if (rest)
+        return (i & ~63) + __builtin_ctzll(rest);
+    return scan_from((i >> 6) + 1);
+}
+
+template <bool Summary>
+    template <typename Op>
+void dynamic_bitset<Summary>::combine(const dynamic_bitset & b, Op op)
+{
+    for (int w = 0; w < n_words; w += LANE) {
+#ifdef __AVX2__
+        __m256i * x = reinterpret_cast<__m256i *>(words + w);
+        _mm256_store_si256(x, op(_mm256_load_si256(x),
+            _mm256_load_si256(reinterpret_cast<const __m256i *>(b.words + w))));
+#else
+        for (int i = w; i < w + LANE; ++i)
+            words[i] = op(words[i], b.words[i]);
+#endif
+    }
+    if (Summary)
+        build_summary();
+}
+
+template <bool Summary>
+dynamic_bitset<Summary> & dynamic_bitset<Summary>::operator&=(const dynamic_bitset & b)
+{
+    combine(b, and_op());
+    return *this;
+}
+
+template <bool Summary>
+dynamic_bitset<Summary> & dynamic_bitset<Summary>::operator|=(const dynamic_bitset & b)
+{
+    combine(b, or_op());
+    return *this;
+}
+
+template <bool Summary>
+dynamic_bitset<Summary> & dynamic_bitset<Summary>::operator^=(const dynamic_bitset & b)
+{
+    combine(b, xor_op());
+    return *this;
+}
+
+template <bool Summary>
+dynamic_bitset<Summary> & dynamic_bitset<Summary>::and_not(const dynamic_bitset & b)
+{
+    combine(b, and_not_op());
+    return *this;
+}
+
+}
+
+#endif // DYNAMIC_BITSET_H_
@@ -0,0 +1,104 @@
+#ifndef FENWICK_TREE_H_
+#define FENWICK_TREE_H_
+
+#include "vector.h"
+
+namespace sx
+{
+
+/**
+* A Fenwick (binary indexed) tree over n values, indexed from 0, for prefix
+* sums of values that change.
+*
+* tree[i] holds the sum of the i & -i values ending at index i - 1, all in
+* one array of n + 1 T's. add and prefix walk O(log n) of them. For
+* nonnegative values, select finds where a prefix sum is first exceeded by
+* binary lifting, e.g. the k-th 1 among 0/1 marks, as in Josephus
+* elimination.
+*/
+template <typename T>
+class fenwick_tree
+{
+private:
+    int n;
+    vector<T> tree;
+public:
+    // n_: the number of values, all T() at first
+    explicit fenwick_tree(int n_);
+    /**
+    * Build from the values in a, in O(n).
+    */
+    explicit fenwick_tree(const vector<T> & a);
+
+    int size() const noexcept { return n; }
+    // add delta to the value at i
+    void add(int i, const T& delta) noexcept;
+    // the sum of the values in [0, i)
+    T prefix(int i) const noexcept;
+    // the sum of the values in [first, last)
+    T sum(int first, int last) const noexcept { return prefix(last) - prefix(first); }
+    /**
+    * Assume that no value is negative.
+    *
+    * return: the least i such that prefix(i + 1) > k, or n if there is
+    * none, e.g. the index of the k-th 1 counting from 0 among 0/1 values
+    */
+    int select(T k) const noexcept;
+};
+
+template <typename T>
+fenwick_tree<T>::fenwick_tree(int n_) : n(n_), tree(n_ + 1)
+{
+    for (int i = 0; i <= n; ++i)
+        tree[i] = T();
+}
+
+template <typename T>
+fenwick_tree<T>::fenwick_tree(const vector<T> & a) : n(a.size()), tree(a.size() + 1)
+{
+    tree[0] = T();
+    for (int i = 1; i <= n; ++i)
+        tree[i] = a[i - 1];
+    // each node passes its sum on to the next node covering it
+    for (int i = 1; i <= n; ++i) {
+        int j = i + (i & -i);
+        if (j <= n)
+            tree[j] += tree[i];
+    }
+}
+
+template <typename T>
+void fenwick_tree<T>::add(int i, const T& delta) noexcept
+{
+    for (++i; i <= n; i += i & -i)
+        tree[i] += delta;
+}
+
+template <typename T>
+T fenwick_tree<T>::prefix(int i) const noexcept
+{
+    T s = T();
+    for (; i > 0; i -= i & -i)
+        s += tree[i];
+    return s;
+}
+
+template <typename T>
+int fenwick_tree<T>::select(T k) const noexcept
+{
+    int step = 1;
+    while (2 * step <= n)
+        step *= 2;
+    // descend from the largest power of two, keeping prefix(i) <= k
+    int i = 0;
+    for (; step; step /= 2)
+        if (i + step <= n && !(k < tree[i + step])) {
+            i += step;
+            k -= tree[i];
+        }
+    return i;
+}
+
+}
+
+#endif // FENWICK_TREE_H_
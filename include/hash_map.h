@@ -0,0 +1,426 @@
+#ifndef HASH_MAP_H_
+#define HASH_MAP_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <new>
+#include <utility>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace sx
+{
+
+/**
+* Masks over a group of 16 control bytes of a hash_table, bit i for byte i.
+* A control byte is EMPTY, DELETED or, for a full slot, 7 bits of the hash
+* of its key.
+*/
+struct hash_group
+{
+    static const signed char EMPTY = -128;
+    static const signed char DELETED = -2;
+
+#ifdef __SSE2__
+    static unsigned match(const signed char * c, signed char h2) noexcept
+    {
+        __m128i g = _mm_load_si128(reinterpret_cast<const __m128i *>(c));
+        return _mm_movemask_epi8(_mm_cmpeq_epi8(g, _mm_set1_epi8(h2)));
+    }
+    static unsigned match_empty(const signed char * c) noexcept
+    {
+        return match(c, EMPTY);
+    }
+    // empty or deleted slots, the only control bytes below -1
+    static unsigned match_free(const signed char * c) noexcept
+    {
+        __m128i g = _mm_load_si128(reinterpret_cast<const __m128i *>(c));
+        return _mm_movemask_epi8(_mm_cmplt_epi8(g, _mm_set1_epi8(-1)));
+    }
+#else
+    static unsigned match(const signed char * c, signed char h2) noexcept
+    {
+        unsigned m = 0;
+        for (int i = 0; i < 16; ++i)
+            m |= unsigned(c[i] == h2) << i;
+        return m;
+    }
+    static unsigned match_empty(const signed char * c) noexcept
+    {
+        return match(c, EMPTY);
+    }
+    static unsigned match_free(const signed char * c) noexcept
+    {
+        unsigned m = 0;
+        for (int i = 0; i < 16; ++i)
+            m |= unsigned(c[i] < -1) << i;
+        return m;
+    }
+#endif
+};
+
+/**
+* The open-addressing table behind hash_map and hash_set, after the Swiss
+* tables of Abseil.
+*
+* Slots are split into groups of 16 with one control byte each, kept apart
+* from the slots. A lookup hashes the key once: the high 7 bits are matched
+* against the control bytes of a whole group with one SSE2 compare, and only
+* the slots matching are compared by key, so a probe rarely touches a slot
+* that does not hold the key. Groups are probed from the one given by the
+* low bits with triangular steps, which visit all groups of a power-of-two
+* table, and a lookup ends at the first group with an empty slot.
+*
+* An erased slot becomes empty again when its group already has an empty
+* slot, since no probe can have gone past such a group, and only otherwise
+* is left as a tombstone (DELETED). The table grows at 7/8 full, counting
+* tombstones.
+*
+* KeyOf::get(value) gives the key of a stored value.
+*/
+template <typename Value, typename Key, typename KeyOf, typename Hash>
+class hash_table
+{
+protected:
+    static const int GROUP = 16;
+
+    unsigned char * raw;
+    // capacity control bytes, 16-aligned, then the slots
+    signed char * ctrl;
+    Value * slots;
+    int capacity, var_size;
+    // inserts into empty slots left before growing
+    int growth_left;
+
+    template <typename Q>
+    static std::size_t hash(const Q& key) noexcept
+    {
+        // spread the bits of weak hashes, e.g. the identity for ints
+        unsigned long long h = Hash()(key) * 0x9e3779b97f4a7c15ULL;
+        return h ^ h >> 32;
+    }
+    static signed char h2(std::size_t h) noexcept { return h >> 57; }
+
+    void allocate(int capacity_);
+    // move the values into a table of new_capacity slots, a power of two
+    void resize(int new_capacity);
+    // resize to the least capacity holding n values at 7/8 full
+    void rehash(int n);
+    // the slot of key with hash h, or -1
+    template <typename Q>
+    int find_slot(const Q& key, std::size_t h) const noexcept;
+    template <typename Q>
+    int find_slot(const Q& key) const noexcept { return find_slot(key, hash(key)); }
+    // the slot for a key known to be absent, with hash h
+    int free_slot(std::size_t h) noexcept;
+    /**
+    * return: the slot of key and true if it was added, in which case the
+    * slot is to be constructed by the caller
+    */
+    std::pair<int, bool> prepare_insert(const Key& key);
+    void erase_slot(int i) noexcept;
+public:
+    template <typename V>
+    class basic_iterator
+    {
+    private:
+        const signed char * c, * end;
+        V * p;
+
+        void skip() noexcept
+        {
+            for (; c != end && *c < 0; ++c, ++p);
+        }
+    public:
+        basic_iterator(const signed char * c_, const signed char * end_, V * p_) noexcept
+            : c(c_), end(end_), p(p_)
+        {
+            skip();
+        }
+
+        V& operator*() const noexcept { return *p; }
+        V * operator->() const noexcept { return p; }
+        basic_iterator & operator++() noexcept
+        {
+            ++c;
+            ++p;
+            skip();
+            return *this;
+        }
+        bool operator==(const basic_iterator & i) const noexcept { return c == i.c; }
+        bool operator!=(const basic_iterator & i) const noexcept { return c != i.c; }
+    };
+    typedef basic_iterator<Value> iterator;
+    typedef basic_iterator<const Value> const_iterator;
+
+    hash_table() { allocate(GROUP); }
+    hash_table(hash_table && t)
+        : raw(t.raw), ctrl(t.ctrl), slots(t.slots), capacity(t.capacity),
+          var_size(t.var_size), growth_left(t.growth_left)
+    {
+        t.allocate(GROUP);
+    }
+    hash_table(const hash_table &) = delete;
+    hash_table & operator=(const hash_table &) = delete;
+    ~hash_table();
+
+    int size() const noexcept { return var_size; }
+    bool empty() const noexcept { return !var_size; }
+    iterator begin() noexcept { return iterator(ctrl, ctrl + capacity, slots); }
+    iterator end() noexcept
+    {
+        return iterator(ctrl + capacity, ctrl + capacity, slots + capacity);
+    }
+    const_iterator begin() const noexcept
+    {
+        return const_iterator(ctrl, ctrl + capacity, slots);
+    }
+    const_iterator end() const noexcept
+    {
+        return const_iterator(ctrl + capacity, ctrl + capacity, slots + capacity);
+    }
+
+    /**
+    * Make room for n values, so that up to n inserts do not rehash.
+    */
+    void reserve(int n)
+    {
+        if (n - var_size > growth_left)
+            rehash(n);
+    }
+    void clear() noexcept;
+
+    /**
+    * Lookups take any type that Hash and == accept along with Key, e.g. a
+    * string_view for string keys, without converting it to Key.
+    */
+    template <typename Q>
+    bool contains(const Q& key) const noexcept { return find_slot(key) >= 0; }
+    template <typename Q>
+    bool erase(const Q& key) noexcept
+    {
+        int i = find_slot(key);
+        if (i < 0)
+            return false;
+        erase_slot(i);
+        return true;
+    }
+};
+
+template <typename Value, typename Key, typename KeyOf, typename Hash>
+void hash_table<Value, Key, KeyOf, Hash>::allocate(int capacity_)
+{
+    capacity = capacity_;
+    var_size = 0;
+    growth_left = capacity - capacity / 8;
+    raw = new unsigned char [capacity + GROUP + capacity * sizeof(Value) + alignof(Value)];
+    std::uintptr_t addr = reinterpret_cast<std::uintptr_t>(raw) + GROUP - 1;
+    addr -= addr % GROUP;
+    ctrl = reinterpret_cast<signed char *>(addr);
+    addr += capacity + alignof(Value) - 1;
+    addr -= addr % alignof(Value);
+    slots = reinterpret_cast<Value *>(addr);
+    for (int i = 0; i < capacity; ++i)
+        ctrl[i] = hash_group::EMPTY;
+}
+
+template <typename Value, typename Key, typename KeyOf, typename Hash>
+hash_table<Value, Key, KeyOf, Hash>::~hash_table()
+{
+    for (int i = 0; i < capacity; ++i)
+        if (ctrl[i] >= 0)
+            slots[i].~Value();
+    delete []raw;
+}
+
+template <typename Value, typename Key, typename KeyOf, typename Hash>
+void hash_table<Value, Key, KeyOf, Hash>::rehash(int n)
+{
+    int new_capacity = GROUP;
+    while (new_capacity - new_capacity / 8 < n)
+        new_capacity *= 2;
+    resize(new_capacity);
+}
+
+template <typename Value, typename Key, typename KeyOf, typename Hash>
+void hash_table<Value, Key, KeyOf, Hash>::resize(int new_capacity)
+{
+    unsigned char * old_raw = raw;
+    signed char * old_ctrl = ctrl;
+    Value * old_slots = slots;
+    int old_capacity = capacity, old_size = var_size;
+    allocate(new_capacity);
+    for (int i = 0; i < old_capacity; ++i)
+        if (old_ctrl[i] >= 0) {
+            std::size_t h = hash(KeyOf::get(old_slots[i]));
+            int j = free_slot(h);
+            ctrl[j] = h2(h);
+            new (slots + j) Value(std::move(old_slots[i]));
+            old_slots[i].~Value();
+        }
+    var_size = old_size;
+    growth_left -= old_size;
+    delete []old_raw;
+}
+
+template <typename Value, typename Key, typename KeyOf, typename Hash>
+void hash_table<Value, Key, KeyOf, Hash>::clear() noexcept
+{
+    for (int i = 0; i < capacity; ++i)
+        if (ctrl[i] >= 0)
+            slots[i].~Value();
+    for (int i = 0; i < capacity; ++i)
+        ctrl[i] = hash_group::EMPTY;
+    var_size = 0;
+    growth_left = capacity - capacity / 8;
+}
+
+template <typename Value, typename Key, typename KeyOf, typename Hash>
+    template <typename Q>
+int hash_table<Value, Key, KeyOf, Hash>::find_slot(const Q& key, std::size_t h) const noexcept
+{
+    std::size_t mask = capacity / GROUP - 1, g = h & mask;
+    for (std::size_t step = 1; ; g = (g + step++) & mask) {
+        const signed char * c = ctrl + g * GROUP;
+        for (unsigned m = hash_group::match(c, h2(h)); m; m &= m - 1) {
+            int i = g * GROUP + __builtin_ctz(m);
+            if (KeyOf::get(slots[i]) == key)
+                return i;
+        }
+        if (hash_group::match_empty(c))
+            return -1;
+    }
+}
+
+template <typename Value, typename Key, typename KeyOf, typename Hash>
+int hash_table<Value, Key, KeyOf, Hash>::free_slot(std::size_t h) noexcept
+{
+    std::size_t mask = capacity / GROUP - 1, g = h & mask;
+    for (std::size_t step = 1; ; g = (g + step++) & mask)
+        if (unsigned m = hash_group::match_free(ctrl + g * GROUP))
+            return g * GROUP + __builtin_ctz(m);
+}
+
+template <typename Value, typename Key, typename KeyOf, typename Hash>
+std::pair<int, bool> hash_table<Value, Key, KeyOf, Hash>::prepare_insert(const Key& key)
+{
+    std::size_t h = hash(key);
+    int i = find_slot(key, h);
+    if (i >= 0)
+        return std::make_pair(i, false);
+    i = free_slot(h);
+    if (ctrl[i] == hash_group::EMPTY && !growth_left) {
+        // twice as large, unless tombstones are most of what is full
+        if (var_size + 1 > capacity / 2)
+            resize(2 * capacity);
+        else
+            rehash(var_size + 1);
+        i = free_slot(h);
+    }
+    if (ctrl[i] == hash_group::EMPTY)
+        --growth_left;
+    ctrl[i] = h2(h);
+    ++var_size;
+    return std::make_pair(i, true);
+}
+
+template <typename Value, typename Key, typename KeyOf, typename Hash>
+void hash_table<Value, Key, KeyOf, Hash>::erase_slot(int i) noexcept
+{
+    slots[i].~Value();
+    --var_size;
+    if (hash_group::match_empty(ctrl + i / GROUP * GROUP)) {
+        ctrl[i] = hash_group::EMPTY;
+        ++growth_left;
+    }
+    else
+        ctrl[i] = hash_group::DELETED;
+}
+
+template <typename K, typename V>
+struct hash_map_key
+{
+    static const K& get(const std::pair<K, V>& p) noexcept { return p.first; }
+};
+
+template <typename K>
+struct hash_set_key
+{
+    static const K& get(const K& k) noexcept { return k; }
+};
+
+/**
+* An unordered map in a flat hash_table, holding std::pair<K, V> in place.
+* Pointers to values stay valid until the table grows.
+*/
+template <typename K, typename V, typename Hash = std::hash<K>>
+class hash_map : public hash_table<std::pair<K, V>, K, hash_map_key<K, V>, Hash>
+{
+private:
+    typedef hash_table<std::pair<K, V>, K, hash_map_key<K, V>, Hash> table;
+public:
+    typedef std::pair<K, V> value_type;
+
+    /**
+    * return: the value of key, added with V() if absent
+    */
+    V& operator[](const K& key)
+    {
+        std::pair<int, bool> r = this->prepare_insert(key);
+        if (r.second)
+            new (this->slots + r.first) value_type(key, V());
+        return this->slots[r.first].second;
+    }
+    /**
+    * Add key with value unless key is already in.
+    *
+    * return: the pair of key and whether it was added
+    */
+    std::pair<value_type *, bool> insert(const K& key, const V& value)
+    {
+        std::pair<int, bool> r = this->prepare_insert(key);
+        if (r.second)
+            new (this->slots + r.first) value_type(key, value);
+        return std::make_pair(this->slots + r.first, r.second);
+    }
+    /**
+    * return: the pair of key, or nullptr
+    */
+    template <typename Q>
+    value_type * find(const Q& key) noexcept
+    {
+        int i = this->find_slot(key);
+        return i < 0 ? nullptr : this->slots + i;
+    }
+    template <typename Q>
+    const value_type * find(const Q& key) const noexcept
+    {
+        int i = this->find_slot(key);
+        return i < 0 ? nullptr : this->slots + i;
+    }
+};
+
+/**
+* An unordered set in a flat hash_table.
+*/
+template <typename K, typename Hash = std::hash<K>>
+class hash_set : public hash_table<K, K, hash_set_key<K>, Hash>
+{
+public:
+    /**
+    * return: false if key was already in
+    */
+    bool insert(const K& key)
+    {
+        std::pair<int, bool> r = this->prepare_insert(key);
+        if (r.second)
+            new (this->slots + r.first) K(key);
+        return r.second;
+    }
+};
+
+}
+
+#endif // HASH_MAP_H_
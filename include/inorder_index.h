@@ -0,0 +1,42 @@
+#ifndef INORDER_INDEX_H_
+#define INORDER_INDEX_H_
+
+#include <iterator>
+#include "hash_map.h"
+
+namespace sx
+{
+
+/**
+* The position of every key of an inorder walk in a hash_map, for
+* linked_binary_tree::create_root to find each root in O(1) instead of by a
+* scan, so that building any tree takes O(n) time. Keys must be distinct,
+* and their type needs std::hash.
+*/
+template <typename RandomIt>
+class inorder_index
+{
+private:
+    typedef typename std::iterator_traits<RandomIt>::value_type T;
+
+    RandomIt first;
+    hash_map<T, int> at;
+public:
+    // first_: the inorder walk of n keys
+    inorder_index(RandomIt first_, int n) : first(first_)
+    {
+        at.reserve(n);
+        for (int i = 0; i < n; ++i)
+            at.insert(first[i], i);
+    }
+
+    // the position of key in the walk, which is in any part of it
+    RandomIt operator()(const T& key, RandomIt, RandomIt) const
+    {
+        return first + at.find(key)->second;
+    }
+};
+
+}
+
+#endif // INORDER_INDEX_H_
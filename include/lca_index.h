@@ -0,0 +1,179 @@
+#ifndef LCA_INDEX_H_
+#define LCA_INDEX_H_
+
+#include "linked_binary_tree.h"
+#include "stack.h"
+#include "chunked_array.h"
+#include "task_scheduler.h"
+
+namespace sx
+{
+
+/**
+* An index over a tree whose nodes are in one array, e.g. from
+* linked_binary_tree::link_nodes, answering lowest common ancestor and
+* subtree queries in O(1) instead of walking up parent pointers.
+*
+* A preorder walk gives every node an entry time tin and, with the subtree
+* size, an exit time tout: u is in the subtree of v exactly when
+* [tin[u], tout[u]] is inside [tin[v], tout[v]]. For tin[u] < tin[v], the
+* lowest common ancestor of u and v is the parent of the shallowest node
+* entered in (tin[u], tin[v]], which is also the parent entered first. A
+* sparse table of the entry times of parents answers that range minimum
+* with two lookups, using O(n log n) ints. Its levels are filled in parallel
+* on the shared task_scheduler for large trees.
+*/
+template <typename T>
+class lca_index
+{
+private:
+    typedef typename linked_binary_tree<T>::node node;
+
+    const node * nodes;
+    int n, levels;
+    // by node index: entry and exit times of the preorder walk
+    int * tin, * tout;
+    // by time: the index of the node entered, then level j of the sparse
+    // table, table[j * n + t] being the least parent entry time over
+    // [t, t + 2^j)
+    int * order, * table;
+
+    void fill(int j, int first, int last, int grain);
+    int id(const node * u) const noexcept { return int(u - nodes); }
+public:
+    /**
+    * nodes_: the array of nodes, all in one tree
+    * n_: the size of the array
+    * grain: sparse table rows no longer than this are filled sequentially
+    */
+    lca_index(const node * nodes_, int n_, int grain = 1 << 16);
+    lca_index(const lca_index &) = delete;
+    lca_index & operator=(const lca_index &) = delete;
+    ~lca_index();
+
+    const node * lca(const node * u, const node * v) const noexcept;
+    /**
+    * lca of u[i] and v[i] for i in [0, count) into out
+    */
+    void lca(const node * const * u, const node * const * v, int count,
+             const node ** out) const noexcept;
+    /**
+    * return: whether u is in the subtree rooted at v, v included
+    */
+    bool in_subtree(const node * u, const node * v) const noexcept
+    {
+        return tin[id(v)] <= tin[id(u)] && tout[id(u)] <= tout[id(v)];
+    }
+    int subtree_size(const node * v) const noexcept
+    {
+        return tout[id(v)] - tin[id(v)] + 1;
+    }
+};
+
+template <typename T>
+lca_index<T>::lca_index(const node * nodes_, int n_, int grain)
+    : nodes(nodes_), n(n_), levels(0)
+{
+    while (n >> levels)
+        ++levels;
+    tin = new int [n];
+    tout = new int [n];
+    order = new int [n];
+    table = new int [levels * n];
+    if (!n)
+        return;
+
+    const node * root = nodes;
+    while (root->p)
+        root = root->p;
+    // preorder walk
+    stack<const node *, chunked_array<const node *>> s;
+    s.push(root);
+    int t = 0;
+    const node * u;
+    while (!s.empty()) {
+        u = s.top();
+        s.pop();
+        tin[id(u)] = t;
+        order[t] = id(u);
+        table[t++] = u->p ? tin[id(u->p)] : 0;
+        if (u->right)
+            s.push(u->right);
+        if (u->left)
+            s.push(u->left);
+    }
+    // subtree sizes in reverse preorder, children before parents
+    for (int i = 0; i < n; ++i)
+        tout[i] = 1;
+    for (t = n - 1; t > 0; --t)
+        tout[order[table[t]]] += tout[order[t]];
+    for (int i = 0; i < n; ++i)
+        tout[i] += tin[i] - 1;
+
+    for (int j = 1; j < levels; ++j)
+        fill(j, 0, n - (1 << j) + 1, grain);
+}
+
+template <typename T>
+void lca_index<T>::fill(int j, int first, int last, int grain)
+{
+    if (last - first <= grain) {
+        const int * below = table + (j - 1) * n;
+        int * row = table + j * n, half = 1 << (j - 1);
+        for (int t = first; t < last; ++t)
+            row[t] = below[t] < below[t + half] ? below[t] : below[t + half];
+        return;
+    }
+    int mid = first + (last - first) / 2;
+    task_scheduler::instance().fork_join(
+        [=] { fill(j, first, mid, grain); },
+        [=] { fill(j, mid, last, grain); });
+}
+
+template <typename T>
+lca_index<T>::~lca_index()
+{
+    delete []tin;
+    delete []tout;
+    delete []order;
+    delete []table;
+}
+
+template <typename T>
+const typename lca_index<T>::node * lca_index<T>::lca(
+        const node * u, const node * v) const noexcept
+{
+    int a = tin[id(u)], b = tin[id(v)];
+    if (a == b)
+        return u;
+    if (a > b) {
+        int temp = a;
+        a = b;
+        b = temp;
+    }
+    // minimum over (a, b] from two overlapping power-of-two ranges
+    int j = 31 - __builtin_clz(b - a);
+    const int * row = table + j * n;
+    int m = row[a + 1] < row[b - (1 << j) + 1] ? row[a + 1] : row[b - (1 << j) + 1];
+    return nodes + order[m];
+}
+
+template <typename T>
+void lca_index<T>::lca(const node * const * u, const node * const * v,
+                       int count, const node ** out) const noexcept
+{
+    // Queries are independent, so the table lookups of consecutive ones
+    // overlap in the pipeline. Prefetch the entry times of queries ahead.
+    const int AHEAD = 8;
+    for (int i = 0; i < count; ++i) {
+        if (i + AHEAD < count) {
+            __builtin_prefetch(tin + id(u[i + AHEAD]));
+            __builtin_prefetch(tin + id(v[i + AHEAD]));
+        }
+        out[i] = lca(u[i], v[i]);
+    }
+}
+
+}
+
+#endif // LCA_INDEX_H_
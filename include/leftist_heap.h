@@ -0,0 +1,132 @@
+#ifndef LEFTIST_HEAP_H_
+#define LEFTIST_HEAP_H_
+
+#include "object_pool.h"
+
+namespace sx
+{
+
+/**
+* A min leftist heap: O(log n) push, pop and meld, O(1) top.
+*
+* Every node records its rank, the length of the shortest path down to a
+* missing child, and the left child never ranks lower than the right one.
+* The right spine is therefore at most log(n + 1) long, and two heaps are
+* melded by merging their right spines.
+*
+* Nodes come from an object_pool, the heap's own by default. Heaps built on
+* one pool_type instead share it, which is what allows meld to move nodes
+* between them without copying. Like the pool, such heaps are not
+* thread-safe: heaps used on different threads need different pools.
+*/
+template <typename T>
+class leftist_heap
+{
+private:
+    struct node
+    {
+        T key;
+        node * left, * right;
+        int rank;
+
+        node(const T& key_) : key(key_), left(nullptr), right(nullptr), rank(1) {}
+    };
+
+    // used unless a pool is given
+    object_pool<node> own;
+    object_pool<node> & pool;
+    node * root;
+    int var_size;
+
+    static int rank(const node * n) noexcept { return n ? n->rank : 0; }
+    static node * merge(node * a, node * b) noexcept;
+    // free a tree iteratively by rotating left children up
+    void clear(node * n) noexcept;
+public:
+    typedef object_pool<node> pool_type;
+
+    leftist_heap() noexcept : pool(own), root(nullptr), var_size(0) {}
+    /**
+    * Draw nodes from p, which must outlive the heap, so that the heap can be
+    * melded with others on p.
+    */
+    explicit leftist_heap(pool_type & p) noexcept : pool(p), root(nullptr), var_size(0) {}
+    leftist_heap(const leftist_heap &) = delete;
+    leftist_heap & operator=(const leftist_heap &) = delete;
+    ~leftist_heap() { clear(root); }
+
+    int size() const noexcept { return var_size; }
+    bool empty() const noexcept { return !var_size; }
+    const T& top() const noexcept { return root->key; }
+    void push(const T& value)
+    {
+        root = merge(root, pool.create(value));
+        ++var_size;
+    }
+    void pop() noexcept
+    {
+        // assume heap non-empty
+        node * temp = root;
+        root = merge(root->left, root->right);
+        pool.destroy(temp);
+        --var_size;
+    }
+    /**
+    * Move all elements of h into this heap in O(log n), leaving h empty.
+    * h must draw from the same pool as this heap.
+    */
+    void meld(leftist_heap & h) noexcept
+    {
+        root = merge(root, h.root);
+        var_size += h.var_size;
+        h.root = nullptr;
+        h.var_size = 0;
+    }
+};
+
+template <typename T>
+typename leftist_heap<T>::node *
+leftist_heap<T>::merge(node * a, node * b) noexcept
+{
+    if (!a)
+        return b;
+    if (!b)
+        return a;
+    node * temp;
+    if (a->key > b->key) {
+        temp = a;
+        a = b;
+        b = temp;
+    }
+    // recursion only follows right spines, so its depth is O(log n)
+    a->right = merge(a->right, b);
+    if (rank(a->left) < rank(a->right)) {
+        temp = a->left;
+        a->left = a->right;
+        a->right = temp;
+    }
+    a->rank = rank(a->right) + 1;
+    return a;
+}
+
+template <typename T>
+void leftist_heap<T>::clear(node * n) noexcept
+{
+    node * temp;
+    while (n)
+        if (n->left) {
+            temp = n->left;
+            n->left = temp->right;
+            temp->right = n;
+            n = temp;
+        }
+        else {
+            temp = n->right;
+            pool.destroy(n);
+            n = temp;
+        }
+}
+
+}
+
+#endif // LEFTIST_HEAP_H_
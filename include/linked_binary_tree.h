@@ -1,9 +1,15 @@
 #ifndef LINKED_BINARY_TREE_H
 #define LINKED_BINARY_TREE_H
 
+#include <algorithm>
 #include <iostream>
+#include <type_traits>
 #include "queue.h"
 #include "stack.h"
+#include "chunked_array.h"
+#include "unrolled_forward_list.h"
+#include "object_pool.h"
+#include "vector.h"
 
 namespace sx
 {
@@ -20,14 +26,31 @@ public:
     public:
         node() noexcept : p(nullptr), left(nullptr), right(nullptr) {}
         node(const T& key_, node * left_ = nullptr, node * right_ = nullptr) noexcept
-            : key(key_), left(left_), right(right_) {}
+            : key(key_), p(nullptr), left(left_), right(right_) {}
 
         int degree() const noexcept { return bool(left) + bool(right); }
+
+        friend class linked_binary_tree;
+        template <typename> friend class avl_tree;
+        template <typename> friend class lca_index;
+        template <typename> friend class parallel_tree;
+        template <typename, typename...> friend class subtree_aggregates;
+        template <typename> friend class succinct_binary_tree;
+        template <typename> friend class tree_dag;
     };
+    /**
+    * Where a tree created from its walks keeps its nodes: one new per node,
+    * or all in an arena freed at once with the tree.
+    */
+    enum class storage {heap, arena};
 protected:
     node * root;
     // whether the tree rooted at node * root is created with dynamic memory
     bool is_dynamic;
+    // the arena holding the nodes, or nullptr for nodes from new
+    object_pool<node> * arena;
+    // what frees the nodes of a heap tree when it is destroyed
+    void (*eraser)(node *);
 
     class node_iterator_post
     {
@@ -43,7 +66,9 @@ protected:
             frame(node * n_) : n(n_), going_right(true) {}
         };
         
-        stack<frame> s;
+        // frames live in reusable chunks, so a deep walk does not allocate
+        // once per node
+        stack<frame, chunked_array<frame>> s;
         
         /**
         * @brief Find the first node to traverse in a post order walk of the
@@ -75,16 +100,21 @@ protected:
         static node_iterator_post end;
     };
 public:
-    linked_binary_tree(node * root_) noexcept : root(root_), is_dynamic(false) {}
+    linked_binary_tree(node * root_) noexcept
+        : root(root_), is_dynamic(false), arena(nullptr), eraser(&erase) {}
     template <typename RandomIt>
-    linked_binary_tree(RandomIt preorder_first, RandomIt preorder_last, RandomIt inorder_first)
-        : root(create_root(preorder_first, preorder_last, inorder_first)),
-        is_dynamic(true) {}
-    ~linked_binary_tree()
-    {
-        if (is_dynamic)
-            erase(root);
-    }
+    linked_binary_tree(RandomIt preorder_first, RandomIt preorder_last,
+                       RandomIt inorder_first, storage s = storage::heap);
+    // a copy would free the same nodes or arena again
+    linked_binary_tree(const linked_binary_tree &) = delete;
+    linked_binary_tree & operator=(const linked_binary_tree &) = delete;
+    ~linked_binary_tree();
+
+    /**
+    * Free the nodes of a heap tree with f(root) when the tree is destroyed,
+    * instead of with erase, e.g. erase_background<T> from tree_reclaim.h.
+    */
+    void erase_with(void (*f)(node *)) noexcept { eraser = f; }
     
     node_iterator_post begin_post() { return node_iterator_post(root); }
     node_iterator_post end_post() { return node_iterator_post::end; }
@@ -93,6 +123,25 @@ public:
     * Check whether the binary tree is complete.
     */
     bool complete() const;
+    /**
+    * return: the keys in the order of an inorder walk, e.g. for freeze in
+    * tree_freeze.h
+    */
+    vector<T> inorder_keys() const;
+    /**
+    * Check whether the tree given as arrays of children, as in the input of
+    * link_nodes, is complete, without building any node.
+    *
+    * left, right: left[i] and right[i] are the children of the i-th node,
+    * numbered from 1, with 0 for no child
+    * n: the number of nodes
+    */
+    static bool complete(const int * left, const int * right, int n);
+    /**
+    * complete(left, right, n) with at as scratch space of at least n ints,
+    * for callers checking many trees with one buffer
+    */
+    static bool complete(const int * left, const int * right, int n, int * at);
 
     /**
     * Construct a tree rooted at the returned node from its preorder and
@@ -101,10 +150,27 @@ public:
     * preorder_first, preorder_last: the preorder walk of the tree
     * inorder_first: the inorder walk of the tree, assuming that the array has
     * the same size
+    *
+    * Keys are assumed distinct. Each root is found in the inorder walk by a
+    * scan, which takes O(n^2) time on degenerate trees, e.g. a chain.
     */
     template <typename RandomIt>
     static node * create_root(RandomIt preorder_first, RandomIt preorder_last,
                               RandomIt inorder_first);
+    /**
+    * create_root with the nodes created in arena
+    */
+    template <typename RandomIt>
+    static node * create_root(RandomIt preorder_first, RandomIt preorder_last,
+                              RandomIt inorder_first, object_pool<node> & arena);
+    /**
+    * create_root with each root found in its part [first, last) of the
+    * inorder walk by find(key, first, last) instead of a scan, e.g. in O(1)
+    * by an inorder_index from inorder_index.h
+    */
+    template <typename RandomIt, typename Find>
+    static node * create_root(RandomIt preorder_first, RandomIt preorder_last,
+                              RandomIt inorder_first, const Find & find);
 
     /**
     * Link nodes in an array together to form a tree based on input in the form
@@ -120,11 +186,58 @@ public:
     static node * link_nodes(node * nodes, int arr_size, bool read_key = true);
 
     /**
-    * Free memory allocated to nodes in a postorder fashion.
+    * Free memory allocated to nodes, in O(n) time and O(1) space whatever the
+    * shape of the tree.
     */
     static void erase(node * n);
+private:
+    // create_root with roots found by find and nodes from make(key)
+    template <typename RandomIt, typename Find, typename Make>
+    static node * build(RandomIt preorder_first, RandomIt preorder_last,
+                        RandomIt inorder_first, const Find & find, Make & make);
+    // find for create_root by a scan
+    template <typename RandomIt>
+    static RandomIt scan(const T& key, RandomIt first, RandomIt) noexcept
+    {
+        for (; *first != key; ++first);
+        return first;
+    }
+
+    template <typename> friend class parallel_tree;
 };
 
+template <typename T>
+    template <typename RandomIt>
+linked_binary_tree<T>::linked_binary_tree(RandomIt preorder_first,
+        RandomIt preorder_last, RandomIt inorder_first, storage s)
+    : is_dynamic(true), arena(nullptr), eraser(&erase)
+{
+    if (s == storage::arena) {
+        arena = new object_pool<node>(1024);
+        root = create_root(preorder_first, preorder_last, inorder_first, *arena);
+    }
+    else
+        root = create_root(preorder_first, preorder_last, inorder_first);
+}
+
+template <typename T>
+linked_binary_tree<T>::~linked_binary_tree()
+{
+    if (arena) {
+        // Trivially destructible nodes are dropped with their blocks, a few
+        // frees for the whole tree.
+        if (!std::is_trivially_destructible<T>::value)
+            for (auto i = begin_post(); i != end_post(); ) {
+                node * n = *i;
+                ++i;
+                n->~node();
+            }
+        delete arena;
+    }
+    else if (is_dynamic && root)
+        eraser(root);
+}
+
 template <typename T>
 inline void linked_binary_tree<T>::node_iterator_post::find_first(node * root)
 {
@@ -132,8 +245,11 @@ inline void linked_binary_tree<T>::node_iterator_post::find_first(node * root)
         s.push(root);
         if (root->left)
             root = root->left;
-        else if (root->right)
+        else if (root->right) {
+            // without a left subtree, going right happens now, not later
+            s.top().going_right = false;
             root = root->right;
+        }
         else
             break;
     }
@@ -162,7 +278,7 @@ linked_binary_tree<T>::node_iterator_post::end;
 template <typename T>
 bool linked_binary_tree<T>::complete() const
 {
-    queue<const node *> q;
+    queue<const node *, unrolled_forward_list<const node *>> q;
     // will be set to false once a 0 or 1 degree node is encountered
     bool no_leaf_node = true;
     q.push(root);
@@ -189,34 +305,125 @@ bool linked_binary_tree<T>::complete() const
 }
 
 template <typename T>
-    template <typename RandomIt>
-typename linked_binary_tree<T>::node * linked_binary_tree<T>::create_root(
-        RandomIt preorder_first, RandomIt preorder_last, RandomIt inorder_first)
+vector<T> linked_binary_tree<T>::inorder_keys() const
+{
+    vector<T> keys;
+    stack<const node *, chunked_array<const node *>> s;
+    const node * n = root;
+    // inorder walk
+    while (n || !s.empty()) {
+        for (; n; n = n->left)
+            s.push(n);
+        n = s.top();
+        s.pop();
+        keys.push_back(n->key);
+        n = n->right;
+    }
+    return keys;
+}
+
+template <typename T>
+bool linked_binary_tree<T>::complete(const int * left, const int * right, int n)
+{
+    int * at = new int [n];
+    bool is_complete = complete(left, right, n, at);
+    delete []at;
+    return is_complete;
+}
+
+template <typename T>
+bool linked_binary_tree<T>::complete(const int * left, const int * right, int n,
+                                     int * at)
+{
+    if (!n)
+        return true;
+    // the root is the only node that is no one's child
+    long long root = (long long)n * (n + 1) / 2;
+    for (int i = 0; i < n; ++i)
+        root -= left[i] + right[i];
+
+    // Number the nodes heap-style, children of position i at 2i + 1 and
+    // 2i + 2. The tree is complete if and only if the n nodes take exactly
+    // positions 0 to n - 1, so every position must be taken when reached in
+    // order. A plain array in place of a queue: one int per node.
+    std::fill(at, at + n, 0);
+    at[0] = int(root);
+    for (int i = 0, v; i < n; ++i) {
+        if (!(v = at[i]))
+            return false;
+        if (left[v - 1]) {
+            if (2LL * i + 1 >= n)
+                return false;
+            at[2 * i + 1] = left[v - 1];
+        }
+        if (right[v - 1]) {
+            if (2LL * i + 2 >= n)
+                return false;
+            at[2 * i + 2] = right[v - 1];
+        }
+    }
+    return true;
+}
+
+template <typename T>
+    template <typename RandomIt, typename Find, typename Make>
+typename linked_binary_tree<T>::node * linked_binary_tree<T>::build(
+        RandomIt preorder_first, RandomIt preorder_last, RandomIt inorder_first,
+        const Find & find, Make & make)
 {
     // create the root from the first element of the preorder walk
-    node * root = new node(*preorder_first);
-    RandomIt root_pos;
+    node * root = make(*preorder_first);
     // find the position of the root in the inorder walk
-    for (root_pos = inorder_first; *root_pos != root->key; ++root_pos);
+    RandomIt root_pos = find(root->key, inorder_first,
+                             inorder_first + (preorder_last - preorder_first));
 
     // divide the inorder walk array into left and right
     int left_size = root_pos - inorder_first;
     if (left_size == 1)
-        root->left = new node(*inorder_first);
+        root->left = make(*inorder_first);
     else if (left_size)
-        root->left = create_root(
-            preorder_first + 1, preorder_first + left_size + 1, inorder_first);
+        root->left = build(preorder_first + 1, preorder_first + left_size + 1,
+                           inorder_first, find, make);
     // for the right part
     int right_size = inorder_first + (preorder_last - preorder_first) - root_pos - 1;
     if (right_size == 1)
-        root->right = new node(*(root_pos + 1));
+        root->right = make(*(root_pos + 1));
     else if (right_size)
-        root->right = create_root(
-            preorder_first + left_size + 1, preorder_last, root_pos + 1);
+        root->right = build(preorder_first + left_size + 1, preorder_last,
+                            root_pos + 1, find, make);
 
     return root;
 }
 
+template <typename T>
+    template <typename RandomIt>
+typename linked_binary_tree<T>::node * linked_binary_tree<T>::create_root(
+        RandomIt preorder_first, RandomIt preorder_last, RandomIt inorder_first)
+{
+    auto make = [](const T& key) { return new node(key); };
+    return build(preorder_first, preorder_last, inorder_first, &scan<RandomIt>, make);
+}
+
+template <typename T>
+    template <typename RandomIt>
+typename linked_binary_tree<T>::node * linked_binary_tree<T>::create_root(
+        RandomIt preorder_first, RandomIt preorder_last, RandomIt inorder_first,
+        object_pool<node> & arena)
+{
+    auto make = [&arena](const T& key) { return arena.create(key); };
+    return build(preorder_first, preorder_last, inorder_first, &scan<RandomIt>, make);
+}
+
+template <typename T>
+    template <typename RandomIt, typename Find>
+typename linked_binary_tree<T>::node * linked_binary_tree<T>::create_root(
+        RandomIt preorder_first, RandomIt preorder_last, RandomIt inorder_first,
+        const Find & find)
+{
+    auto make = [](const T& key) { return new node(key); };
+    return build(preorder_first, preorder_last, inorder_first, find, make);
+}
+
 template <typename T>
 typename linked_binary_tree<T>::node *
 linked_binary_tree<T>::link_nodes(node * nodes, int arr_size, bool read_key)
@@ -258,11 +465,21 @@ linked_binary_tree<T>::link_nodes(node * nodes, int arr_size, bool read_key)
 template <typename T>
 void linked_binary_tree<T>::erase(node * n)
 {
-    if (n->left)
-        erase(n->left);
-    if (n->right)
-        erase(n->right);
-    delete n;
+    node * l;
+    while (n) {
+        if (n->left) {
+            // rotate right until n has no left child, so no stack is needed
+            l = n->left;
+            n->left = l->right;
+            l->right = n;
+            n = l;
+        }
+        else {
+            l = n->right;
+            delete n;
+            n = l;
+        }
+    }
 }
 
 }
@@ -0,0 +1,150 @@
+#ifndef LOCK_FREE_STACK_H_
+#define LOCK_FREE_STACK_H_
+
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <utility>
+
+namespace sx
+{
+
+/**
+* A bounded lock-free stack for any number of threads (Treiber stack).
+*
+* Nodes come from a fixed array and are linked by index, and the head of the
+* stack is a 64-bit word holding a 32-bit node index together with a 32-bit
+* tag bumped by every successful CAS. A thread that read the head, got
+* preempted, and meanwhile saw the same node popped and pushed back (ABA)
+* therefore fails its CAS instead of corrupting the list. As nodes are never
+* freed, a stale next index may be read but never dereferences freed memory.
+*
+* Unused nodes are kept in a second stack of the same kind.
+*/
+template <typename T>
+class lock_free_stack
+{
+private:
+    static const int CACHE_LINE = 64;
+    static const std::uint32_t NIL = 0xffffffff;
+
+    struct node
+    {
+        T value;
+        std::atomic<std::uint32_t> next;
+    };
+
+    node * nodes;
+    int var_capacity;
+    // packed (tag << 32 | index) heads of the stack and the free list
+    alignas(CACHE_LINE) std::atomic<std::uint64_t> top;
+    alignas(CACHE_LINE) std::atomic<std::uint64_t> free_top;
+
+    static std::uint32_t index(std::uint64_t head) noexcept
+    {
+        return std::uint32_t(head);
+    }
+    static std::uint64_t pack(std::uint32_t i, std::uint64_t old) noexcept
+    {
+        return ((old >> 32) + 1) << 32 | i;
+    }
+
+    std::uint32_t pop_node(std::atomic<std::uint64_t> & head) noexcept;
+    void push_node(std::atomic<std::uint64_t> & head, std::uint32_t i) noexcept;
+public:
+    explicit lock_free_stack(int capacity);
+    lock_free_stack(const lock_free_stack &) = delete;
+    lock_free_stack & operator=(const lock_free_stack &) = delete;
+    ~lock_free_stack() { delete []nodes; }
+
+    int capacity() const noexcept { return var_capacity; }
+    bool empty() const noexcept
+    {
+        return index(top.load(std::memory_order_acquire)) == NIL;
+    }
+
+    /**
+    * return: false if all nodes are in use
+    */
+    bool try_push(const T& value);
+    /**
+    * return: false if the stack is empty
+    */
+    bool try_pop(T& value);
+    void push(const T& value)
+    {
+        while (!try_push(value))
+            std::this_thread::yield();
+    }
+    void pop(T& value)
+    {
+        while (!try_pop(value))
+            std::this_thread::yield();
+    }
+};
+
+template <typename T>
+lock_free_stack<T>::lock_free_stack(int capacity)
+    : nodes(new node [capacity]), var_capacity(capacity), top(NIL), free_top(0)
+{
+    // chain all nodes into the free list
+    for (int i = 0; i < capacity; ++i)
+        nodes[i].next.store(i + 1 < capacity ? i + 1 : NIL,
+            std::memory_order_relaxed);
+    if (!capacity)
+        free_top.store(NIL, std::memory_order_relaxed);
+}
+
+template <typename T>
+std::uint32_t lock_free_stack<T>::pop_node(std::atomic<std::uint64_t> & head) noexcept
+{
+    std::uint64_t old = head.load(std::memory_order_acquire);
+    std::uint32_t i;
+    do {
+        i = index(old);
+        if (i == NIL)
+            return NIL;
+        // The node may be popped and reused by another thread right now, in
+        // which case next is stale and the tag makes the CAS below fail.
+    } while (!head.compare_exchange_weak(old,
+            pack(nodes[i].next.load(std::memory_order_relaxed), old),
+            std::memory_order_acquire, std::memory_order_acquire));
+    return i;
+}
+
+template <typename T>
+void lock_free_stack<T>::push_node(std::atomic<std::uint64_t> & head,
+                                   std::uint32_t i) noexcept
+{
+    std::uint64_t old = head.load(std::memory_order_relaxed);
+    do
+        nodes[i].next.store(index(old), std::memory_order_relaxed);
+    while (!head.compare_exchange_weak(old, pack(i, old),
+            std::memory_order_release, std::memory_order_relaxed));
+}
+
+template <typename T>
+bool lock_free_stack<T>::try_push(const T& value)
+{
+    std::uint32_t i = pop_node(free_top);
+    if (i == NIL)
+        return false;
+    nodes[i].value = value;
+    push_node(top, i);
+    return true;
+}
+
+template <typename T>
+bool lock_free_stack<T>::try_pop(T& value)
+{
+    std::uint32_t i = pop_node(top);
+    if (i == NIL)
+        return false;
+    value = std::move(nodes[i].value);
+    push_node(free_top, i);
+    return true;
+}
+
+}
+
+#endif // LOCK_FREE_STACK_H_
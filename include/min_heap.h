@@ -1,33 +1,192 @@
 #ifndef MIN_HEAP_H_INCLUDED
 #define MIN_HEAP_H_INCLUDED
 
+#include <cstdint>
+#include <new>
+#include <utility>
 #include "vector.h"
+#if defined(__SSE4_1__) || defined(__AVX2__)
+#include <immintrin.h>
+#endif
 
 namespace sx
 {
 
-template <typename T> class min_heap;
+template <typename T, int D> class min_heap;
 
-template <typename T>
-std::ostream &operator<<(std::ostream &os, const min_heap<T> &h);
+template <typename T, int D>
+std::ostream &operator<<(std::ostream &os, const min_heap<T, D> &h);
 
-template <typename T>
+/**
+* Find the least of the D keys starting at c, returning its offset. The
+* generic version compares one by one. Specialisations below use SIMD to
+* compare all children at once for int and float keys.
+*/
+template <typename T, int D>
+struct least_child
+{
+    static int find(const T * c) noexcept
+    {
+        int least = 0;
+        for (int i = 1; i < D; ++i)
+            if (c[least] > c[i])
+                least = i;
+        return least;
+    }
+};
+
+#ifdef __SSE4_1__
+template <>
+struct least_child<int, 4>
+{
+    static int find(const int * c) noexcept
+    {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(c));
+        // broadcast the minimum to all lanes by folding halves together
+        __m128i m = _mm_min_epi32(v, _mm_shuffle_epi32(v, 0x4e));
+        m = _mm_min_epi32(m, _mm_shuffle_epi32(m, 0xb1));
+        return __builtin_ctz(_mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(v, m))));
+    }
+};
+
+template <>
+struct least_child<float, 4>
+{
+    static int find(const float * c) noexcept
+    {
+        __m128 v = _mm_loadu_ps(c);
+        __m128 m = _mm_min_ps(v, _mm_shuffle_ps(v, v, 0x4e));
+        m = _mm_min_ps(m, _mm_shuffle_ps(m, m, 0xb1));
+        return __builtin_ctz(_mm_movemask_ps(_mm_cmpeq_ps(v, m)));
+    }
+};
+#endif
+
+#ifdef __AVX2__
+template <>
+struct least_child<int, 8>
+{
+    static int find(const int * c) noexcept
+    {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(c));
+        __m256i m = _mm256_min_epi32(v, _mm256_permute2x128_si256(v, v, 1));
+        m = _mm256_min_epi32(m, _mm256_shuffle_epi32(m, 0x4e));
+        m = _mm256_min_epi32(m, _mm256_shuffle_epi32(m, 0xb1));
+        return __builtin_ctz(_mm256_movemask_ps(
+            _mm256_castsi256_ps(_mm256_cmpeq_epi32(v, m))));
+    }
+};
+
+template <>
+struct least_child<float, 8>
+{
+    static int find(const float * c) noexcept
+    {
+        __m256 v = _mm256_loadu_ps(c);
+        __m256 m = _mm256_min_ps(v, _mm256_permute2f128_ps(v, v, 1));
+        m = _mm256_min_ps(m, _mm256_shuffle_ps(m, m, 0x4e));
+        m = _mm256_min_ps(m, _mm256_shuffle_ps(m, m, 0xb1));
+        return __builtin_ctz(_mm256_movemask_ps(_mm256_cmp_ps(v, m, _CMP_EQ_OQ)));
+    }
+};
+#endif
+
+/**
+* A D-ary min heap whose elements can be reached through stable handles.
+*
+* push returns a handle that stays valid, whatever moves happen to the
+* element inside the heap, until the element is popped or erased. A position
+* map from handles to nodes makes decrease_key and erase O(log n).
+*
+* The children of node i are nodes D * i + 1 to D * i + D. Node 1 is put at
+* the start of a cache line, so with D * sizeof(T) dividing 64 (e.g. four or
+* eight ints) all children of a node share one line and a sift-down touches
+* one line per level. A larger D means a shallower heap but more comparisons
+* per level, which SIMD takes care of for int and float keys.
+*/
+template <typename T, int D = 2>
 class min_heap
 {
+    static_assert(D >= 2, "a heap node needs at least two children");
+public:
+    typedef int handle;
 private:
-    vector<T> v;
+    static const int CACHE_LINE = 64;
+
+    // keys at data[0, var_size), data + 1 being aligned to a cache line
+    T * data;
+    unsigned char * raw;
+    int var_size, var_capacity;
+    // handle_at[i]: the handle of the element at node i
+    // index_of[h]: the node holding the element of handle h, or NOT_FOUND
+    vector<handle> handle_at, index_of;
+    // handles released by pop and erase, reused by push
+    vector<handle> free_handles;
 
+    void expand();
     void heapify(int i) noexcept;
+    // build the heap from an arbitrary array in O(n) (Floyd's method)
+    void build() noexcept;
+    handle new_handle();
+    void append(const T& value, handle h);
+    void remove_last() noexcept
+    {
+        data[--var_size].~T();
+        handle_at.pop_back();
+    }
+    // put value of handle h at node i
+    void place(int i, const T& value, handle h) noexcept
+    {
+        data[i] = value;
+        handle_at[i] = h;
+        index_of[h] = i;
+    }
+    int least_child_of(int i) const noexcept;
 
-    static int left(int i) noexcept { return 2 * i + 1; }
-    static int right(int i) noexcept { return 2 * i + 2; }
-    static int parent(int i) noexcept { return i ? (i - 1) / 2 : -1; }
+    static int child(int i) noexcept { return D * i + 1; }
+    static int parent(int i) noexcept { return i ? (i - 1) / D : -1; }
 public:
     static const int NOT_FOUND;
 
-    const T& top() const noexcept { return v.front(); }
-    T& top() noexcept { return v.front(); }
-    void push(const T& value);
+    min_heap() noexcept
+        : data(nullptr), raw(nullptr), var_size(0), var_capacity(0) {}
+    template <typename InputIt>
+    min_heap(InputIt first, InputIt last) : min_heap() { assign(first, last); }
+    min_heap(const min_heap &) = delete;
+    min_heap & operator=(const min_heap &) = delete;
+    ~min_heap();
+
+    int size() const noexcept { return var_size; }
+    bool empty() const noexcept { return !var_size; }
+    const T& top() const noexcept { return data[0]; }
+    T& top() noexcept { return data[0]; }
+    handle top_handle() const noexcept { return handle_at.front(); }
+    handle push(const T& value);
+    /**
+    * Push all elements in [first, last). If there are more of them than
+    * elements in the heap, the heap is rebuilt in O(n) instead of pushing
+    * them one by one.
+    *
+    * handles: if not null, receives the handle of each element in order
+    */
+    template <typename InputIt>
+    void push_range(InputIt first, InputIt last, handle * handles = nullptr);
+    /**
+    * Replace the contents with [first, last), building the heap in O(n).
+    * The i-th element gets the handle i.
+    */
+    template <typename InputIt>
+    void assign(InputIt first, InputIt last);
+    void pop() noexcept { erase(top_handle()); }
+    /**
+    * Give the top element the key value and sink it to its place, cheaper
+    * than pop followed by push. The handle of the top element stays valid.
+    */
+    void replace_top(const T& value) noexcept
+    {
+        data[0] = value;
+        heapify(0);
+    }
 
     /**
     * Find a place for node i whose key may be less than its parent. It
@@ -36,73 +195,223 @@ public:
     */
     void float_up(int i) noexcept;
 
-    const T& operator[](int i) const noexcept { return v[i]; }
+    bool contains(handle h) const noexcept
+    {
+        return h >= 0 && h < index_of.size() && index_of[h] != NOT_FOUND;
+    }
+    const T& key(handle h) const noexcept { return data[index_of[h]]; }
+    /**
+    * Lower the key of the element of handle h to value, which must not be
+    * greater than its current key.
+    */
+    void decrease_key(handle h, const T& value) noexcept;
+    void erase(handle h) noexcept;
+
+    const T& operator[](int i) const noexcept { return data[i]; }
 
     friend std::ostream &operator<< <>(std::ostream &os, const min_heap &h);
 };
 
-template <typename T>
-void min_heap<T>::heapify(int i) noexcept
+template <typename T, int D>
+const int min_heap<T, D>::NOT_FOUND = -1;
+
+template <typename T, int D>
+min_heap<T, D>::~min_heap()
 {
-    // record the least element between node i and its two children
-    int least = i;
-    int l = left(i);
-    int r;
+    for (int i = 0; i < var_size; ++i)
+        data[i].~T();
+    delete []raw;
+}
+
+template <typename T, int D>
+void min_heap<T, D>::expand()
+{
+    int new_capacity = var_capacity ? 2 * var_capacity : CACHE_LINE;
+    unsigned char * new_raw = new unsigned char [new_capacity * sizeof(T) + 2 * CACHE_LINE];
+    // round up to a cache line, then step back so that node 1 starts one
+    std::uintptr_t addr = reinterpret_cast<std::uintptr_t>(new_raw) + CACHE_LINE - 1;
+    addr -= addr % CACHE_LINE;
+    addr += (CACHE_LINE - sizeof(T) % CACHE_LINE) % CACHE_LINE;
+    T * new_data = reinterpret_cast<T *>(addr);
+    for (int i = 0; i < var_size; ++i) {
+        new (new_data + i) T(std::move(data[i]));
+        data[i].~T();
+    }
+    delete []raw;
+    raw = new_raw;
+    data = new_data;
+    var_capacity = new_capacity;
+}
+
+template <typename T, int D>
+inline int min_heap<T, D>::least_child_of(int i) const noexcept
+{
+    int c = child(i);
+    if (c + D <= var_size)
+        return c + least_child<T, D>::find(data + c);
+    // the last internal node may have fewer than D children
+    int least = c;
+    for (int j = c + 1; j < var_size; ++j)
+        if (data[least] > data[j])
+            least = j;
+    return least;
+}
+
+template <typename T, int D>
+void min_heap<T, D>::heapify(int i) noexcept
+{
+    // Like float_up, move the hole down instead of swapping at every level
+    // and only put the key of node i in its final place.
+    T temp = data[i];
+    handle h = handle_at[i];
+    int least;
     // loop as long as the node has children
-    while (l < v.size()) {
-        if (v[least] > v[l])
-            least = l;
-        r = right(i);
-        if (r < v.size() && v[least] > v[r])
-            least = r;
-        if (least == i)     // the element at node i is the least
+    while (child(i) < var_size) {
+        least = least_child_of(i);
+        if (!(temp > data[least]))  // temp is the least, so stop here
             break;
-        else {
-            T temp = v[i];
-            v[i] = v[least];
-            v[least] = temp;
-            i = least;
-        }
-        l = left(i);
+        place(i, data[least], handle_at[least]);
+        i = least;
     }
+    place(i, temp, h);
 }
 
-template <typename T>
-void min_heap<T>::push(const T& value)
+template <typename T, int D>
+void min_heap<T, D>::build() noexcept
 {
-    v.push_back(value);
-    float_up(v.size() - 1);
+    // leaves are heaps already, so start from the last internal node
+    for (int i = parent(var_size - 1); i >= 0; --i)
+        heapify(i);
+}
+
+template <typename T, int D>
+typename min_heap<T, D>::handle min_heap<T, D>::new_handle()
+{
+    if (free_handles.size()) {
+        handle h = free_handles.back();
+        free_handles.pop_back();
+        return h;
+    }
+    index_of.push_back(NOT_FOUND);
+    return index_of.size() - 1;
 }
 
-template <typename T>
-inline void min_heap<T>::float_up(int i) noexcept
+template <typename T, int D>
+void min_heap<T, D>::append(const T& value, handle h)
+{
+    if (var_size == var_capacity)
+        expand();
+    new (data + var_size) T(value);
+    handle_at.push_back(h);
+    index_of[h] = var_size++;
+}
+
+template <typename T, int D>
+typename min_heap<T, D>::handle min_heap<T, D>::push(const T& value)
+{
+    handle h = new_handle();
+    append(value, h);
+    float_up(var_size - 1);
+    return h;
+}
+
+template <typename T, int D>
+    template <typename InputIt>
+void min_heap<T, D>::push_range(InputIt first, InputIt last, handle * handles)
+{
+    int old_size = var_size;
+    handle h;
+    for (; first != last; ++first) {
+        h = new_handle();
+        append(*first, h);
+        if (handles)
+            *handles++ = h;
+    }
+    if (var_size - old_size > old_size)
+        build();
+    else
+        for (int i = old_size; i < var_size; ++i)
+            float_up(i);
+}
+
+template <typename T, int D>
+    template <typename InputIt>
+void min_heap<T, D>::assign(InputIt first, InputIt last)
+{
+    while (var_size)
+        remove_last();
+    index_of.clear();
+    free_handles.clear();
+    for (; first != last; ++first) {
+        index_of.push_back(NOT_FOUND);
+        append(*first, var_size);
+    }
+    build();
+}
+
+template <typename T, int D>
+inline void min_heap<T, D>::float_up(int i) noexcept
 {
     int p = parent(i);
     // manually handle the first swap
-    if (p >= 0 && v[p] > v[i]) {
+    if (p >= 0 && data[p] > data[i]) {
         // optimise swapping by creating a persistent variable temp instead of
         // many temporary ones
-        T temp = v[i];
-        v[i] = v[p];    // assign the parent's key to the node
+        T temp = data[i];
+        handle h = handle_at[i];
+        place(i, data[p], handle_at[p]);    // assign the parent's key to the node
         i = p;
         p = parent(i);
 
-        // compare v[p] with temp but not v[i] because the key stored in the
-        // variable temp hasn't been assigned to any node
-        while (p >= 0 && v[p] > temp) {
-            v[i] = v[p];
+        // compare data[p] with temp but not data[i] because the key stored in
+        // the variable temp hasn't been assigned to any node
+        while (p >= 0 && data[p] > temp) {
+            place(i, data[p], handle_at[p]);
             i = p;
             p = parent(i);
         }
 
-        v[i] = temp;
+        place(i, temp, h);
     }
 }
 
-template <typename T>
-std::ostream &operator<<(std::ostream &os, const min_heap<T> &h)
+template <typename T, int D>
+void min_heap<T, D>::decrease_key(handle h, const T& value) noexcept
 {
-    os << h.v;
+    int i = index_of[h];
+    data[i] = value;
+    float_up(i);
+}
+
+template <typename T, int D>
+void min_heap<T, D>::erase(handle h) noexcept
+{
+    int i = index_of[h];
+    int last = var_size - 1;
+    index_of[h] = NOT_FOUND;
+    free_handles.push_back(h);
+    if (i != last) {
+        // fill the hole with the last element, which may belong either above
+        // or below node i
+        handle moved = handle_at[last];
+        place(i, data[last], moved);
+        remove_last();
+        float_up(i);
+        if (index_of[moved] == i)
+            heapify(i);
+    }
+    else
+        remove_last();
+}
+
+template <typename T, int D>
+std::ostream &operator<<(std::ostream &os, const min_heap<T, D> &h)
+{
+    for (int i = 0; i < h.var_size; ++i) {
+        if (i)
+            os << ' ';
+        os << h.data[i];
+    }
     return os;
 }
 
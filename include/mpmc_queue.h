@@ -0,0 +1,134 @@
+#ifndef MPMC_QUEUE_H_
+#define MPMC_QUEUE_H_
+
+#include <atomic>
+#include <cstddef>
+#include <thread>
+#include <utility>
+
+namespace sx
+{
+
+/**
+* A bounded lock-free queue for any number of producers and consumers, after
+* Dmitry Vyukov's sequence-numbered ring.
+*
+* Every cell carries a sequence number telling which lap of the ring it is
+* ready for: a cell at position pos may be written when its sequence equals
+* pos and read when it equals pos + 1. Producers and consumers claim a
+* position with a CAS on their own counter and then only touch the claimed
+* cell, so the two sides never contend on the same counter.
+*/
+template <typename T>
+class mpmc_queue
+{
+private:
+    static const int CACHE_LINE = 64;
+
+    struct cell
+    {
+        std::atomic<std::size_t> seq;
+        T data;
+    };
+
+    alignas(CACHE_LINE) cell * buffer;
+    std::size_t mask;
+    alignas(CACHE_LINE) std::atomic<std::size_t> enqueue_pos;
+    alignas(CACHE_LINE) std::atomic<std::size_t> dequeue_pos;
+public:
+    /**
+    * capacity: rounded up to a power of two, at least 2
+    */
+    explicit mpmc_queue(int capacity);
+    mpmc_queue(const mpmc_queue &) = delete;
+    mpmc_queue & operator=(const mpmc_queue &) = delete;
+    ~mpmc_queue() { delete []buffer; }
+
+    int capacity() const noexcept { return int(mask + 1); }
+
+    /**
+    * return: false if the queue is full
+    */
+    bool try_push(const T& value);
+    /**
+    * return: false if the queue is empty
+    */
+    bool try_pop(T& value);
+    // spin until the operation succeeds
+    void push(const T& value)
+    {
+        while (!try_push(value))
+            std::this_thread::yield();
+    }
+    void pop(T& value)
+    {
+        while (!try_pop(value))
+            std::this_thread::yield();
+    }
+};
+
+template <typename T>
+mpmc_queue<T>::mpmc_queue(int capacity) : enqueue_pos(0), dequeue_pos(0)
+{
+    std::size_t c = 2;
+    while (c < std::size_t(capacity))
+        c *= 2;
+    buffer = new cell [c];
+    mask = c - 1;
+    for (std::size_t i = 0; i < c; ++i)
+        buffer[i].seq.store(i, std::memory_order_relaxed);
+}
+
+template <typename T>
+bool mpmc_queue<T>::try_push(const T& value)
+{
+    cell * c;
+    std::size_t pos = enqueue_pos.load(std::memory_order_relaxed);
+    while (true) {
+        c = &buffer[pos & mask];
+        std::ptrdiff_t diff = std::ptrdiff_t(c->seq.load(std::memory_order_acquire))
+            - std::ptrdiff_t(pos);
+        if (diff == 0) {
+            // the cell is free for this lap, try to claim it
+            if (enqueue_pos.compare_exchange_weak(pos, pos + 1,
+                    std::memory_order_relaxed))
+                break;
+        }
+        else if (diff < 0)      // the cell still holds last lap's element
+            return false;
+        else                    // another producer claimed pos first
+            pos = enqueue_pos.load(std::memory_order_relaxed);
+    }
+    c->data = value;
+    c->seq.store(pos + 1, std::memory_order_release);
+    return true;
+}
+
+template <typename T>
+bool mpmc_queue<T>::try_pop(T& value)
+{
+    cell * c;
+    std::size_t pos = dequeue_pos.load(std::memory_order_relaxed);
+    while (true) {
+        c = &buffer[pos & mask];
+        std::ptrdiff_t diff = std::ptrdiff_t(c->seq.load(std::memory_order_acquire))
+            - std::ptrdiff_t(pos + 1);
+        if (diff == 0) {
+            if (dequeue_pos.compare_exchange_weak(pos, pos + 1,
+                    std::memory_order_relaxed))
+                break;
+        }
+        else if (diff < 0)      // nothing has been written to the cell yet
+            return false;
+        else
+            pos = dequeue_pos.load(std::memory_order_relaxed);
+    }
+    value = std::move(c->data);
+    // hand the cell over to the producer of the next lap
+    c->seq.store(pos + mask + 1, std::memory_order_release);
+    return true;
+}
+
+}
+
+#endif // MPMC_QUEUE_H_
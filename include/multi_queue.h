@@ -0,0 +1,143 @@
+#ifndef MULTI_QUEUE_H_
+#define MULTI_QUEUE_H_
+
+#include <atomic>
+#include <cstdint>
+#include <type_traits>
+#include "min_heap.h"
+
+namespace sx
+{
+
+/**
+* A relaxed concurrent priority queue (MultiQueue, Rihani et al.): c * T
+* independent min_heaps for T threads, each guarded by a try-lock.
+*
+* push puts the element into a random heap that is not locked. pop samples
+* `choices` random heaps, compares their tops and pops from the heap with the
+* least one. Popped elements are therefore not always the global minimum but
+* close to it: more heaps per thread give more throughput and a larger rank
+* error, more choices a smaller rank error and less throughput.
+*
+* Tops are mirrored in atomics so that comparing them takes no lock, which is
+* why T must be trivially copyable.
+*/
+template <typename T, int D = 4>
+class multi_queue
+{
+    static_assert(std::is_trivially_copyable<T>::value,
+        "keys are read without locks, so they must be trivially copyable");
+private:
+    struct alignas(64) shard
+    {
+        std::atomic_flag locked = ATOMIC_FLAG_INIT;
+        std::atomic<bool> nonempty;
+        std::atomic<T> top;
+        min_heap<T, D> h;
+
+        shard() : nonempty(false) {}
+
+        bool try_lock() noexcept
+        {
+            return !locked.test_and_set(std::memory_order_acquire);
+        }
+        // publish the new top and release the lock
+        void unlock() noexcept
+        {
+            if (!h.empty())
+                top.store(h.top(), std::memory_order_relaxed);
+            nonempty.store(!h.empty(), std::memory_order_relaxed);
+            locked.clear(std::memory_order_release);
+        }
+    };
+
+    shard * shards;
+    int n_shards;
+    int choices;
+
+    static unsigned random() noexcept
+    {
+        static thread_local unsigned state = 0;
+        if (!state)
+            state = unsigned(reinterpret_cast<std::uintptr_t>(&state)) | 1;
+        // xorshift32
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        return state;
+    }
+public:
+    /**
+    * n_threads: number of threads expected to use the queue
+    * c: heaps per thread
+    * choices_: heaps sampled per pop, at least 1
+    */
+    explicit multi_queue(int n_threads, int c = 2, int choices_ = 2);
+    multi_queue(const multi_queue &) = delete;
+    multi_queue & operator=(const multi_queue &) = delete;
+    ~multi_queue() { delete []shards; }
+
+    void push(const T& value);
+    /**
+    * Pop an element close to the minimum into value.
+    *
+    * return: false if all heaps were found empty
+    */
+    bool try_pop(T& value);
+};
+
+template <typename T, int D>
+multi_queue<T, D>::multi_queue(int n_threads, int c, int choices_)
+    : n_shards(n_threads * c > 1 ? n_threads * c : 1),
+    choices(choices_ > 0 ? choices_ : 1)
+{
+    shards = new shard [n_shards];
+}
+
+template <typename T, int D>
+void multi_queue<T, D>::push(const T& value)
+{
+    shard * s;
+    do
+        s = &shards[random() % n_shards];
+    while (!s->try_lock());
+    s->h.push(value);
+    s->unlock();
+}
+
+template <typename T, int D>
+bool multi_queue<T, D>::try_pop(T& value)
+{
+    shard * best, * s;
+    while (true) {
+        best = nullptr;
+        for (int i = 0; i < choices; ++i) {
+            s = &shards[random() % n_shards];
+            if (s->nonempty.load(std::memory_order_relaxed) && (!best
+                    || best->top.load(std::memory_order_relaxed)
+                        > s->top.load(std::memory_order_relaxed)))
+                best = s;
+        }
+        if (!best) {
+            // all samples were empty, so look for any nonempty heap
+            for (int i = 0; i < n_shards && !best; ++i)
+                if (shards[i].nonempty.load(std::memory_order_relaxed))
+                    best = &shards[i];
+            if (!best)
+                return false;
+        }
+        if (best->try_lock()) {
+            if (!best->h.empty()) {
+                value = best->h.top();
+                best->h.pop();
+                best->unlock();
+                return true;
+            }
+            best->unlock();
+        }
+    }
+}
+
+}
+
+#endif // MULTI_QUEUE_H_
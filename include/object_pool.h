@@ -0,0 +1,107 @@
+#ifndef OBJECT_POOL_H_
+#define OBJECT_POOL_H_
+
+#include <new>
+#include <utility>
+
+namespace sx
+{
+
+/**
+* A pool handing out objects of type T from large blocks, for node-based
+* structures that would otherwise call new for every node.
+*
+* Destroyed objects go to a free list and are reused by later creates. Blocks
+* are returned to the system only when the pool is destroyed, so every object
+* must be destroyed (or simply abandoned, if T is trivially destructible)
+* before that. Not thread-safe.
+*/
+template <typename T>
+class object_pool
+{
+private:
+    union slot
+    {
+        slot * next;
+        alignas(T) unsigned char object[sizeof(T)];
+    };
+    struct block
+    {
+        block * next;
+        slot * slots;
+    };
+
+    block * blocks;
+    slot * free_list;
+    // slots not yet handed out in the newest block
+    slot * fresh, * fresh_end;
+    int block_size;
+public:
+    /**
+    * block_size_: the number of objects in the first block. Each following
+    * block is twice as large as the previous one.
+    */
+    explicit object_pool(int block_size_ = 64) noexcept
+        : blocks(nullptr), free_list(nullptr), fresh(nullptr),
+        fresh_end(nullptr), block_size(block_size_) {}
+    object_pool(const object_pool &) = delete;
+    object_pool & operator=(const object_pool &) = delete;
+    ~object_pool() { release(); }
+
+    template <typename... Args>
+    T * create(Args&&... args);
+    void destroy(T * p) noexcept;
+
+    /**
+    * Free all blocks at once without running destructors, invalidating every
+    * object created by the pool.
+    */
+    void release() noexcept;
+};
+
+template <typename T>
+    template <typename... Args>
+T * object_pool<T>::create(Args&&... args)
+{
+    slot * s;
+    if (free_list) {
+        s = free_list;
+        free_list = free_list->next;
+    }
+    else {
+        if (fresh == fresh_end) {
+            blocks = new block {blocks, new slot [block_size]};
+            fresh = blocks->slots;
+            fresh_end = fresh + block_size;
+            block_size *= 2;
+        }
+        s = fresh++;
+    }
+    return new (s->object) T(std::forward<Args>(args)...);
+}
+
+template <typename T>
+void object_pool<T>::destroy(T * p) noexcept
+{
+    p->~T();
+    slot * s = reinterpret_cast<slot *>(p);
+    s->next = free_list;
+    free_list = s;
+}
+
+template <typename T>
+void object_pool<T>::release() noexcept
+{
+    block * temp;
+    while (blocks) {
+        temp = blocks;
+        blocks = blocks->next;
+        delete []temp->slots;
+        delete temp;
+    }
+    free_list = fresh = fresh_end = nullptr;
+}
+
+}
+
+#endif // OBJECT_POOL_H_
@@ -0,0 +1,152 @@
+#ifndef PAIRING_HEAP_H_
+#define PAIRING_HEAP_H_
+
+#include "object_pool.h"
+
+namespace sx
+{
+
+/**
+* A min pairing heap: O(1) push, top and meld, amortized O(log n) pop.
+*
+* A heap is a tree whose root holds the least key. Nodes keep their first
+* child and next sibling. meld links two roots, making the one with the
+* greater key the first child of the other. pop pairs up the children of the
+* root from left to right, then melds the pairs from right to left.
+*
+* Nodes come from an object_pool, the heap's own by default. Heaps built on
+* one pool_type instead share it, which is what allows meld to move nodes
+* between them without copying. Like the pool, such heaps are not
+* thread-safe: heaps used on different threads need different pools.
+*/
+template <typename T>
+class pairing_heap
+{
+private:
+    struct node
+    {
+        T key;
+        node * child, * sibling;
+
+        node(const T& key_) : key(key_), child(nullptr), sibling(nullptr) {}
+    };
+
+    // used unless a pool is given
+    object_pool<node> own;
+    object_pool<node> & pool;
+    node * root;
+    int var_size;
+
+    // meld two trees, both roots having no sibling
+    static node * link(node * a, node * b) noexcept;
+    // free a tree iteratively, treating child as left and sibling as right
+    void clear(node * n) noexcept;
+public:
+    typedef object_pool<node> pool_type;
+
+    pairing_heap() noexcept : pool(own), root(nullptr), var_size(0) {}
+    /**
+    * Draw nodes from p, which must outlive the heap, so that the heap can be
+    * melded with others on p.
+    */
+    explicit pairing_heap(pool_type & p) noexcept : pool(p), root(nullptr), var_size(0) {}
+    pairing_heap(const pairing_heap &) = delete;
+    pairing_heap & operator=(const pairing_heap &) = delete;
+    ~pairing_heap() { clear(root); }
+
+    int size() const noexcept { return var_size; }
+    bool empty() const noexcept { return !var_size; }
+    const T& top() const noexcept { return root->key; }
+    void push(const T& value)
+    {
+        root = link(root, pool.create(value));
+        ++var_size;
+    }
+    void pop() noexcept;
+    /**
+    * Move all elements of h into this heap in O(1), leaving h empty.
+    * h must draw from the same pool as this heap.
+    */
+    void meld(pairing_heap & h) noexcept
+    {
+        root = link(root, h.root);
+        var_size += h.var_size;
+        h.root = nullptr;
+        h.var_size = 0;
+    }
+};
+
+template <typename T>
+inline typename pairing_heap<T>::node *
+pairing_heap<T>::link(node * a, node * b) noexcept
+{
+    if (!a)
+        return b;
+    if (!b)
+        return a;
+    if (a->key > b->key) {
+        node * temp = a;
+        a = b;
+        b = temp;
+    }
+    b->sibling = a->child;
+    a->child = b;
+    return a;
+}
+
+template <typename T>
+void pairing_heap<T>::clear(node * n) noexcept
+{
+    node * temp;
+    while (n)
+        if (n->child) {
+            // rotate the first child up, so that n loses a child
+            temp = n->child;
+            n->child = temp->sibling;
+            temp->sibling = n;
+            n = temp;
+        }
+        else {
+            temp = n->sibling;
+            pool.destroy(n);
+            n = temp;
+        }
+}
+
+template <typename T>
+void pairing_heap<T>::pop() noexcept
+{
+    // assume heap non-empty
+    node * first = root->child, * a, * b;
+    pool.destroy(root);
+    --var_size;
+
+    // first pass: link children in pairs from left to right, stacking the
+    // results in pairs through their sibling pointers
+    node * pairs = nullptr;
+    while (first) {
+        a = first;
+        b = a->sibling;
+        if (b) {
+            first = b->sibling;
+            a->sibling = b->sibling = nullptr;
+            a = link(a, b);
+        }
+        else
+            first = nullptr;
+        a->sibling = pairs;
+        pairs = a;
+    }
+    // second pass: meld the pairs from right to left
+    root = nullptr;
+    while (pairs) {
+        a = pairs;
+        pairs = pairs->sibling;
+        a->sibling = nullptr;
+        root = link(root, a);
+    }
+}
+
+}
+
+#endif // PAIRING_HEAP_H_
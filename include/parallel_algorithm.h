@@ -0,0 +1,30 @@
+#ifndef PARALLEL_ALGORITHM_H_
+#define PARALLEL_ALGORITHM_H_
+
+#include "algorithm.h"
+#include "task_scheduler.h"
+
+namespace sx
+{
+
+/*
+ * quick_sort with the two halves left after partitioning sorted in parallel
+ * on the shared task_scheduler
+ * grain: subarrays no longer than this are sorted sequentially
+ */
+template <typename RandomIt>
+void parallel_quick_sort(RandomIt first, RandomIt last, int grain = 4096)
+{
+    if (last - first <= grain)
+        quick_sort(first, last);
+    else {
+        RandomIt i = partition(first, last);
+        task_scheduler::instance().fork_join(
+            [=] { parallel_quick_sort(first, i, grain); },
+            [=] { parallel_quick_sort(i + 1, last, grain); });
+    }
+}
+
+}
+
+#endif  // PARALLEL_ALGORITHM_H_
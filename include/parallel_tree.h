@@ -0,0 +1,107 @@
+#ifndef PARALLEL_TREE_H_
+#define PARALLEL_TREE_H_
+
+#include "linked_binary_tree.h"
+#include "inorder_index.h"
+#include "task_scheduler.h"
+
+namespace sx
+{
+
+/**
+* create_root and erase of linked_binary_tree with the left and right
+* subtrees handled in parallel on the shared task_scheduler, kept apart so
+* that the tree itself does not pull in the thread pool.
+*/
+template <typename T>
+class parallel_tree
+{
+public:
+    typedef typename linked_binary_tree<T>::node node;
+
+    /**
+    * linked_binary_tree<T>::create_root with the left and right subtrees
+    * built in parallel, finding each root through an inorder_index, so keys
+    * must be distinct and their type needs std::hash
+    *
+    * grain: subtrees with no more nodes than this are built sequentially
+    */
+    template <typename RandomIt>
+    static node * create_root(RandomIt preorder_first, RandomIt preorder_last,
+                              RandomIt inorder_first, int grain = 1024);
+
+    /**
+    * linked_binary_tree<T>::erase with the left and right subtrees freed in
+    * parallel
+    *
+    * levels: the number of levels from n where subtrees are forked, below
+    * which erasing is sequential
+    */
+    static void erase(node * n, int levels = 8);
+private:
+    template <typename RandomIt>
+    static node * build(RandomIt preorder_first, RandomIt preorder_last,
+        RandomIt inorder_first, const inorder_index<RandomIt> & find, int grain);
+};
+
+template <typename T>
+    template <typename RandomIt>
+typename parallel_tree<T>::node * parallel_tree<T>::create_root(
+        RandomIt preorder_first, RandomIt preorder_last, RandomIt inorder_first,
+        int grain)
+{
+    inorder_index<RandomIt> find(inorder_first, preorder_last - preorder_first);
+    return build(preorder_first, preorder_last, inorder_first, find, grain);
+}
+
+template <typename T>
+    template <typename RandomIt>
+typename parallel_tree<T>::node * parallel_tree<T>::build(
+        RandomIt preorder_first, RandomIt preorder_last, RandomIt inorder_first,
+        const inorder_index<RandomIt> & find, int grain)
+{
+    if (preorder_last - preorder_first <= grain) {
+        auto make = [](const T& key) { return new node(key); };
+        return linked_binary_tree<T>::build(preorder_first, preorder_last,
+                                            inorder_first, find, make);
+    }
+
+    node * root = new node(*preorder_first);
+    RandomIt root_pos = find(root->key, inorder_first,
+                             inorder_first + (preorder_last - preorder_first));
+
+    // divide the inorder walk array into left and right and build them apart
+    int left_size = root_pos - inorder_first;
+    int right_size = inorder_first + (preorder_last - preorder_first) - root_pos - 1;
+    task_scheduler::instance().fork_join(
+        [=, &find] {
+            if (left_size)
+                root->left = build(preorder_first + 1,
+                    preorder_first + left_size + 1, inorder_first, find, grain);
+        },
+        [=, &find] {
+            if (right_size)
+                root->right = build(preorder_first + left_size + 1,
+                    preorder_last, root_pos + 1, find, grain);
+        });
+
+    return root;
+}
+
+template <typename T>
+void parallel_tree<T>::erase(node * n, int levels)
+{
+    if (levels <= 0 || !n->left || !n->right) {
+        linked_binary_tree<T>::erase(n);
+        return;
+    }
+    node * left = n->left, * right = n->right;
+    task_scheduler::instance().fork_join(
+        [=] { erase(left, levels - 1); },
+        [=] { erase(right, levels - 1); });
+    delete n;
+}
+
+}
+
+#endif // PARALLEL_TREE_H_
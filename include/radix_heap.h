@@ -0,0 +1,115 @@
+#ifndef RADIX_HEAP_H_
+#define RADIX_HEAP_H_
+
+#include <type_traits>
+#include "vector.h"
+
+namespace sx
+{
+
+/**
+* A monotone priority queue of unsigned integer keys: a key pushed must not
+* be less than the last key popped, though it may be less than top(), as
+* with event times or Dijkstra distances. It offers the push/top/pop of
+* min_heap without comparing keys.
+*
+* Bucket 0 holds keys equal to last, the last minimum, and bucket i > 0
+* keys whose highest bit differing from last is bit i - 1. When bucket 0 runs
+* out, the first nonempty bucket gives the new minimum and is redistributed
+* into lower buckets. A key only ever moves to lower buckets, so each push
+* and pop costs amortized O(log C) for keys up to C.
+*/
+template <typename T = unsigned>
+class radix_heap
+{
+    static_assert(std::is_unsigned<T>::value, "keys must be unsigned integers");
+private:
+    static const int N_BUCKETS = sizeof(T) * 8 + 1;
+
+    // Only pop moves last on: the minimum is not popped by top, so keys
+    // between last and it may still be pushed.
+    vector<T> buckets[N_BUCKETS];
+    int var_size;
+    T last;
+    // the minimum found by top while bucket 0 is empty, if least_valid
+    mutable T least;
+    mutable bool least_valid;
+
+    int bucket(T key) const noexcept
+    {
+        return key == last ? 0
+            : sizeof(unsigned long long) * 8 - __builtin_clzll(key ^ last);
+    }
+    // the first nonempty bucket, assuming bucket 0 is empty
+    int first_bucket() const noexcept
+    {
+        int i = 1;
+        while (!buckets[i].size())
+            ++i;
+        return i;
+    }
+    // move last on to the minimum and refill bucket 0 from its bucket
+    void pull();
+public:
+    radix_heap() noexcept : var_size(0), last(0), least_valid(false) {}
+
+    int size() const noexcept { return var_size; }
+    bool empty() const noexcept { return !var_size; }
+    const T& top() const noexcept;
+    void push(const T& key);
+    void pop();
+};
+
+template <typename T>
+const T& radix_heap<T>::top() const noexcept
+{
+    // assume heap non-empty
+    if (buckets[0].size())
+        return last;
+    if (!least_valid) {
+        const vector<T> & b = buckets[first_bucket()];
+        least = b.front();
+        for (const T& key : b)
+            if (key < least)
+                least = key;
+        least_valid = true;
+    }
+    return least;
+}
+
+template <typename T>
+void radix_heap<T>::pull()
+{
+    int i = first_bucket();
+    last = top();
+    // every key in bucket i now differs from last in a lower bit
+    for (const T& key : buckets[i])
+        buckets[bucket(key)].push_back(key);
+    buckets[i].clear();
+}
+
+template <typename T>
+void radix_heap<T>::push(const T& key)
+{
+    // assume key >= last
+    buckets[bucket(key)].push_back(key);
+    if (least_valid && key < least)
+        least = key;
+    ++var_size;
+}
+
+template <typename T>
+void radix_heap<T>::pop()
+{
+    // assume heap non-empty
+    if (!buckets[0].size())
+        pull();
+    buckets[0].pop_back();
+    --var_size;
+    // the minimum found by top may have been the key just popped
+    least_valid = false;
+}
+
+}
+
+#endif // RADIX_HEAP_H_
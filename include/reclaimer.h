@@ -0,0 +1,109 @@
+#ifndef RECLAIMER_H_
+#define RECLAIMER_H_
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include "queue.h"
+
+namespace sx
+{
+
+/**
+* A background thread that frees memory handed to it, so that tearing down
+* a large structure does not stall the thread that drops it.
+*
+* A job is a function and its argument, run on the reclaimer thread in the
+* order submitted. The thread starts with the first job. Jobs still queued
+* when the program exits are run before it ends.
+*/
+class reclaimer
+{
+private:
+    struct job
+    {
+        void (*run)(void *);
+        void * arg;
+    };
+
+    std::mutex m;
+    std::condition_variable cv, idle;
+    queue<job> jobs;
+    // jobs submitted but not finished
+    int pending;
+    bool stop;
+    std::thread t;
+
+    reclaimer() noexcept : pending(0), stop(false) {}
+    void loop();
+public:
+    reclaimer(const reclaimer &) = delete;
+    reclaimer & operator=(const reclaimer &) = delete;
+    ~reclaimer();
+
+    // the reclaimer shared by the whole program
+    static reclaimer & instance()
+    {
+        static reclaimer r;
+        return r;
+    }
+
+    /**
+    * Run run(arg) on the reclaimer thread.
+    */
+    void submit(void (*run)(void *), void * arg);
+    /**
+    * Block until every job submitted so far has finished.
+    */
+    void drain();
+};
+
+inline reclaimer::~reclaimer()
+{
+    {
+        std::lock_guard<std::mutex> lock(m);
+        stop = true;
+    }
+    cv.notify_one();
+    if (t.joinable())
+        t.join();
+}
+
+inline void reclaimer::loop()
+{
+    std::unique_lock<std::mutex> lock(m);
+    while (true) {
+        cv.wait(lock, [this] { return stop || !jobs.empty(); });
+        if (jobs.empty())
+            return;
+        job j = jobs.front();
+        jobs.pop();
+        lock.unlock();
+        j.run(j.arg);
+        lock.lock();
+        if (!--pending)
+            idle.notify_all();
+    }
+}
+
+inline void reclaimer::submit(void (*run)(void *), void * arg)
+{
+    {
+        std::lock_guard<std::mutex> lock(m);
+        jobs.push(job {run, arg});
+        ++pending;
+        if (!t.joinable())
+            t = std::thread(&reclaimer::loop, this);
+    }
+    cv.notify_one();
+}
+
+inline void reclaimer::drain()
+{
+    std::unique_lock<std::mutex> lock(m);
+    idle.wait(lock, [this] { return !pending; });
+}
+
+}
+
+#endif // RECLAIMER_H_
@@ -0,0 +1,242 @@
+#ifndef SEGMENT_TREE_H_
+#define SEGMENT_TREE_H_
+
+#include <limits>
+#include "vector.h"
+
+namespace sx
+{
+
+/**
+* Monoids for segment_tree: identity() and combine(a, b) of values over
+* adjacent ranges, a on the left.
+*/
+template <typename T>
+struct sum_monoid
+{
+    typedef T value_type;
+
+    static T identity() { return T(); }
+    static T combine(const T& a, const T& b) { return a + b; }
+};
+
+template <typename T>
+struct min_monoid
+{
+    typedef T value_type;
+
+    static T identity() { return std::numeric_limits<T>::max(); }
+    static T combine(const T& a, const T& b) { return b < a ? b : a; }
+};
+
+template <typename T>
+struct max_monoid
+{
+    typedef T value_type;
+
+    static T identity() { return std::numeric_limits<T>::lowest(); }
+    static T combine(const T& a, const T& b) { return a < b ? b : a; }
+};
+
+/**
+* Updates of ranges for segment_tree: identity() changes nothing,
+* apply(f, x, len) is the value x of a range of len elements after f, and
+* compose(f, g) is f after g.
+*/
+// add to every element of a range, kept as sums
+template <typename T>
+struct add_to_sum
+{
+    typedef T value_type;
+
+    static T identity() { return T(); }
+    static T apply(const T& f, const T& x, int len) { return x + f * len; }
+    static T compose(const T& f, const T& g) { return f + g; }
+};
+
+// add to every element of a range, kept as minima or maxima
+template <typename T>
+struct add_to_extremum
+{
+    typedef T value_type;
+
+    static T identity() { return T(); }
+    static T apply(const T& f, const T& x, int) { return x + f; }
+    static T compose(const T& f, const T& g) { return f + g; }
+};
+
+/**
+* A segment tree over n values combined by Monoid, with updates of whole
+* ranges by Lazy, in O(log n) per query and update.
+*
+* The tree is perfect over a power of two leaves in two arrays, values in
+* d[1, 2 * leaves) and pending updates of inner nodes in lz[1, leaves), node k
+* having children 2k and 2k + 1. Queries and updates work bottom-up from the
+* two leaves bounding the range, as in the AtCoder Library, pushing pending
+* updates down only along the paths to those leaves first. The policies are
+* template parameters, so their calls are inlined into the loops.
+*/
+template <typename Monoid, typename Lazy>
+class segment_tree
+{
+private:
+    typedef typename Monoid::value_type value_type;
+    typedef typename Lazy::value_type lazy_type;
+
+    int n, leaves, log;
+    vector<value_type> d;
+    vector<lazy_type> lz;
+
+    // the number of leaves under node k
+    int length(int k) const noexcept { return leaves >> (31 - __builtin_clz(k)); }
+    void update(int k) { d[k] = Monoid::combine(d[2 * k], d[2 * k + 1]); }
+    void all_apply(int k, const lazy_type & f)
+    {
+        d[k] = Lazy::apply(f, d[k], length(k));
+        if (k < leaves)
+            lz[k] = Lazy::compose(f, lz[k]);
+    }
+    void push(int k)
+    {
+        all_apply(2 * k, lz[k]);
+        all_apply(2 * k + 1, lz[k]);
+        lz[k] = Lazy::identity();
+    }
+    void init();
+public:
+    // n_: the number of values, all Monoid::identity() at first
+    explicit segment_tree(int n_);
+    /**
+    * Build from the values in a, in O(n).
+    */
+    explicit segment_tree(const vector<value_type> & a);
+
+    int size() const noexcept { return n; }
+    void set(int i, const value_type & x);
+    value_type get(int i);
+    // the values in [first, last) combined
+    value_type query(int first, int last);
+    // all values combined
+    const value_type & all() const noexcept { return d[1]; }
+    // apply f to the value at i
+    void apply(int i, const lazy_type & f);
+    // apply f to the values in [first, last)
+    void apply(int first, int last, const lazy_type & f);
+};
+
+template <typename Monoid, typename Lazy>
+void segment_tree<Monoid, Lazy>::init()
+{
+    for (log = 0, leaves = 1; leaves < n; ++log, leaves *= 2);
+    d = vector<value_type>(2 * leaves);
+    lz = vector<lazy_type>(leaves);
+    for (int k = 0; k < 2 * leaves; ++k)
+        d[k] = Monoid::identity();
+    for (int k = 0; k < leaves; ++k)
+        lz[k] = Lazy::identity();
+}
+
+template <typename Monoid, typename Lazy>
+segment_tree<Monoid, Lazy>::segment_tree(int n_) : n(n_)
+{
+    init();
+}
+
+template <typename Monoid, typename Lazy>
+segment_tree<Monoid, Lazy>::segment_tree(const vector<value_type> & a) : n(a.size())
+{
+    init();
+    for (int i = 0; i < n; ++i)
+        d[leaves + i] = a[i];
+    for (int k = leaves - 1; k > 0; --k)
+        update(k);
+}
+
+template <typename Monoid, typename Lazy>
+void segment_tree<Monoid, Lazy>::set(int i, const value_type & x)
+{
+    i += leaves;
+    for (int j = log; j > 0; --j)
+        push(i >> j);
+    d[i] = x;
+    for (int j = 1; j <= log; ++j)
+        update(i >> j);
+}
+
+template <typename Monoid, typename Lazy>
+typename segment_tree<Monoid, Lazy>::value_type segment_tree<Monoid, Lazy>::get(int i)
+{
+    i += leaves;
+    for (int j = log; j > 0; --j)
+        push(i >> j);
+    return d[i];
+}
+
+template <typename Monoid, typename Lazy>
+typename segment_tree<Monoid, Lazy>::value_type
+segment_tree<Monoid, Lazy>::query(int first, int last)
+{
+    if (first == last)
+        return Monoid::identity();
+    first += leaves;
+    last += leaves;
+    // push down to the nodes just inside the range ends, unless a whole node
+    // starts or ends there
+    for (int j = log; j > 0; --j) {
+        if (((first >> j) << j) != first)
+            push(first >> j);
+        if (((last >> j) << j) != last)
+            push((last - 1) >> j);
+    }
+    value_type l = Monoid::identity(), r = Monoid::identity();
+    for (; first < last; first >>= 1, last >>= 1) {
+        if (first & 1)
+            l = Monoid::combine(l, d[first++]);
+        if (last & 1)
+            r = Monoid::combine(d[--last], r);
+    }
+    return Monoid::combine(l, r);
+}
+
+template <typename Monoid, typename Lazy>
+void segment_tree<Monoid, Lazy>::apply(int i, const lazy_type & f)
+{
+    i += leaves;
+    for (int j = log; j > 0; --j)
+        push(i >> j);
+    d[i] = Lazy::apply(f, d[i], 1);
+    for (int j = 1; j <= log; ++j)
+        update(i >> j);
+}
+
+template <typename Monoid, typename Lazy>
+void segment_tree<Monoid, Lazy>::apply(int first, int last, const lazy_type & f)
+{
+    if (first == last)
+        return;
+    first += leaves;
+    last += leaves;
+    for (int j = log; j > 0; --j) {
+        if (((first >> j) << j) != first)
+            push(first >> j);
+        if (((last >> j) << j) != last)
+            push((last - 1) >> j);
+    }
+    // apply f to the nodes covering the range, then update their ancestors
+    for (int l = first, r = last; l < r; l >>= 1, r >>= 1) {
+        if (l & 1)
+            all_apply(l++, f);
+        if (r & 1)
+            all_apply(--r, f);
+    }
+    for (int j = 1; j <= log; ++j) {
+        if (((first >> j) << j) != first)
+            update(first >> j);
+        if (((last >> j) << j) != last)
+            update((last - 1) >> j);
+    }
+}
+
+}
+
+#endif // SEGMENT_TREE_H_
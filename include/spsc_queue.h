@@ -0,0 +1,322 @@
+#ifndef SPSC_QUEUE_H_
+#define SPSC_QUEUE_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+namespace sx
+{
+
+/**
+* What push and pop do when the queue is full or empty respectively: spin
+* (yielding now and then) or go to sleep until the other side makes progress.
+*/
+enum class wait_mode {busy, blocking};
+
+/**
+* A bounded lock-free queue for exactly one producer thread and one consumer
+* thread, e.g. to connect reading, computing and writing stages of a solver.
+*
+* The queue is a ring indexed by two free-running counters. Each side owns
+* one counter and keeps a cached copy of the other's, all on separate cache
+* lines, so that a push or pop normally touches no line written by the
+* other thread. A counter is published with a release store and read with an
+* acquire load, which makes the element written before it visible.
+*
+* close() marks the end of the stream: pop then fails once the queue drains.
+*/
+template <typename T, wait_mode W = wait_mode::busy>
+class spsc_queue
+{
+private:
+    static const int CACHE_LINE = 64;
+    // spin this many times before yielding or going to sleep
+    static const int SPIN_LIMIT = 64;
+
+    // fields read by both threads but never written
+    alignas(CACHE_LINE) T * buffer;
+    std::size_t mask;
+
+    // written by the consumer
+    alignas(CACHE_LINE) std::atomic<std::size_t> head;
+    std::size_t tail_cache;
+
+    // written by the producer
+    alignas(CACHE_LINE) std::atomic<std::size_t> tail;
+    std::size_t head_cache;
+
+    // only touched when a thread has to wait
+    alignas(CACHE_LINE) std::atomic<bool> closed;
+    std::atomic<int> sleepers;
+    std::mutex m;
+    std::condition_variable cv;
+
+    template <typename Predicate>
+    void wait(Predicate ready);
+    void notify();
+public:
+    /**
+    * capacity: rounded up to a power of two
+    */
+    explicit spsc_queue(int capacity);
+    spsc_queue(const spsc_queue &) = delete;
+    spsc_queue & operator=(const spsc_queue &) = delete;
+    ~spsc_queue() { delete []buffer; }
+
+    int capacity() const noexcept { return int(mask + 1); }
+    // approximate if called while the other thread is running
+    int size() const noexcept
+    {
+        return int(tail.load(std::memory_order_acquire)
+            - head.load(std::memory_order_acquire));
+    }
+    bool empty() const noexcept { return !size(); }
+
+    // producer side
+    bool try_push(const T& value);
+    bool try_push(T&& value);
+    void push(const T& value);
+    void push(T&& value);
+    /**
+    * Push as many elements of [first, first + n) as there is room for.
+    *
+    * return: the number of elements pushed
+    */
+    int try_push(const T * first, int n);
+    /**
+    * Push all n elements, waiting for room as many times as needed.
+    */
+    void push(const T * first, int n);
+    void close();
+
+    // consumer side
+    bool try_pop(T& value);
+    /**
+    * Wait for an element and move it into value.
+    *
+    * return: false if the queue has been closed and drained
+    */
+    bool pop(T& value);
+    /**
+    * Pop up to n elements into out without waiting.
+    *
+    * return: the number of elements popped
+    */
+    int try_pop(T * out, int n);
+    /**
+    * Wait until at least one element is ready, then pop up to n of them.
+    *
+    * return: the number of elements popped, 0 if closed and drained
+    */
+    int pop(T * out, int n);
+};
+
+template <typename T, wait_mode W>
+spsc_queue<T, W>::spsc_queue(int capacity)
+    : head(0), tail_cache(0), tail(0), head_cache(0), closed(false),
+    sleepers(0)
+{
+    std::size_t c = 1;
+    while (c < std::size_t(capacity))
+        c *= 2;
+    buffer = new T [c];
+    mask = c - 1;
+}
+
+template <typename T, wait_mode W>
+    template <typename Predicate>
+void spsc_queue<T, W>::wait(Predicate ready)
+{
+    for (int i = 0; i < SPIN_LIMIT; ++i)
+        if (ready())
+            return;
+    if (W == wait_mode::busy)
+        while (!ready())
+            std::this_thread::yield();
+    else {
+        // Announce the sleep before checking again. Paired with the fence in
+        // notify(), either the other side sees the sleeper or we see its
+        // progress, so no wake-up is lost.
+        sleepers.fetch_add(1);
+        {
+            std::unique_lock<std::mutex> lock(m);
+            cv.wait(lock, ready);
+        }
+        sleepers.fetch_sub(1);
+    }
+}
+
+template <typename T, wait_mode W>
+inline void spsc_queue<T, W>::notify()
+{
+    if (W == wait_mode::blocking) {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (sleepers.load(std::memory_order_relaxed)) {
+            // take the lock so that the notification cannot slip in between
+            // the sleeper's check and its wait
+            { std::lock_guard<std::mutex> lock(m); }
+            cv.notify_all();
+        }
+    }
+}
+
+template <typename T, wait_mode W>
+inline bool spsc_queue<T, W>::try_push(const T& value)
+{
+    T temp(value);
+    return try_push(std::move(temp));
+}
+
+template <typename T, wait_mode W>
+inline bool spsc_queue<T, W>::try_push(T&& value)
+{
+    std::size_t t = tail.load(std::memory_order_relaxed);
+    if (t - head_cache > mask) {
+        head_cache = head.load(std::memory_order_acquire);
+        if (t - head_cache > mask)
+            return false;
+    }
+    buffer[t & mask] = std::move(value);
+    tail.store(t + 1, std::memory_order_release);
+    notify();
+    return true;
+}
+
+template <typename T, wait_mode W>
+void spsc_queue<T, W>::push(const T& value)
+{
+    T temp(value);
+    push(std::move(temp));
+}
+
+template <typename T, wait_mode W>
+void spsc_queue<T, W>::push(T&& value)
+{
+    if (!try_push(std::move(value))) {
+        std::size_t t = tail.load(std::memory_order_relaxed);
+        wait([this, t] {
+            return t - head.load(std::memory_order_acquire) <= mask;
+        });
+        try_push(std::move(value));
+    }
+}
+
+template <typename T, wait_mode W>
+int spsc_queue<T, W>::try_push(const T * first, int n)
+{
+    std::size_t t = tail.load(std::memory_order_relaxed);
+    std::size_t room = mask + 1 - (t - head_cache);
+    if (room < std::size_t(n)) {
+        head_cache = head.load(std::memory_order_acquire);
+        room = mask + 1 - (t - head_cache);
+    }
+    if (room > std::size_t(n))
+        room = n;
+    for (std::size_t i = 0; i < room; ++i)
+        buffer[(t + i) & mask] = first[i];
+    if (room) {
+        tail.store(t + room, std::memory_order_release);
+        notify();
+    }
+    return int(room);
+}
+
+template <typename T, wait_mode W>
+void spsc_queue<T, W>::push(const T * first, int n)
+{
+    int pushed;
+    while (n) {
+        pushed = try_push(first, n);
+        if (!pushed) {
+            std::size_t t = tail.load(std::memory_order_relaxed);
+            wait([this, t] {
+                return t - head.load(std::memory_order_acquire) <= mask;
+            });
+        }
+        first += pushed;
+        n -= pushed;
+    }
+}
+
+template <typename T, wait_mode W>
+void spsc_queue<T, W>::close()
+{
+    closed.store(true, std::memory_order_release);
+    notify();
+}
+
+template <typename T, wait_mode W>
+inline bool spsc_queue<T, W>::try_pop(T& value)
+{
+    std::size_t h = head.load(std::memory_order_relaxed);
+    if (h == tail_cache) {
+        tail_cache = tail.load(std::memory_order_acquire);
+        if (h == tail_cache)
+            return false;
+    }
+    value = std::move(buffer[h & mask]);
+    head.store(h + 1, std::memory_order_release);
+    notify();
+    return true;
+}
+
+template <typename T, wait_mode W>
+bool spsc_queue<T, W>::pop(T& value)
+{
+    while (!try_pop(value)) {
+        // Check closed before the final try_pop: the producer's last push
+        // happens before close(), so nothing can be missed.
+        if (closed.load(std::memory_order_acquire))
+            return try_pop(value);
+        std::size_t h = head.load(std::memory_order_relaxed);
+        wait([this, h] {
+            return tail.load(std::memory_order_acquire) != h
+                || closed.load(std::memory_order_acquire);
+        });
+    }
+    return true;
+}
+
+template <typename T, wait_mode W>
+int spsc_queue<T, W>::try_pop(T * out, int n)
+{
+    std::size_t h = head.load(std::memory_order_relaxed);
+    std::size_t ready = tail_cache - h;
+    if (ready < std::size_t(n)) {
+        tail_cache = tail.load(std::memory_order_acquire);
+        ready = tail_cache - h;
+    }
+    if (ready > std::size_t(n))
+        ready = n;
+    for (std::size_t i = 0; i < ready; ++i)
+        out[i] = std::move(buffer[(h + i) & mask]);
+    if (ready) {
+        head.store(h + ready, std::memory_order_release);
+        notify();
+    }
+    return int(ready);
+}
+
+template <typename T, wait_mode W>
+int spsc_queue<T, W>::pop(T * out, int n)
+{
+    int popped;
+    while (!(popped = try_pop(out, n))) {
+        if (closed.load(std::memory_order_acquire))
+            return try_pop(out, n);
+        std::size_t h = head.load(std::memory_order_relaxed);
+        wait([this, h] {
+            return tail.load(std::memory_order_acquire) != h
+                || closed.load(std::memory_order_acquire);
+        });
+    }
+    return popped;
+}
+
+}
+
+#endif // SPSC_QUEUE_H_
@@ -17,6 +17,8 @@ public:
     void push(const T& value) { return c.push_back(value); }
     void push(T&& value) { return c.push_back(value); }
     void pop() { return c.pop_back(); }
+    // only for containers supporting reserve, e.g. chunked_array
+    void reserve(int n) { c.reserve(n); }
 protected:
     Container c;
 };
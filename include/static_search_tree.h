@@ -0,0 +1,309 @@
+#ifndef STATIC_SEARCH_TREE_H_
+#define STATIC_SEARCH_TREE_H_
+
+#include <cstdint>
+#include <new>
+#include "vector.h"
+
+namespace sx
+{
+
+/**
+* A sorted array frozen into the Eytzinger (BFS) order of a complete binary
+* search tree, for read-mostly lower_bound queries.
+*
+* Node k is at data[k], with children at 2k and 2k + 1, so the top levels of
+* the tree share a few cache lines and the next levels to be visited are
+* easy to prefetch: the 16 nodes four levels below k (for 4-byte keys) are
+* data[16k] to data[16k + 15], one cache line. The search runs a fixed number
+* of iterations with no branch on the keys, and the batch lookup advances
+* several searches in lockstep so their cache misses overlap.
+*/
+template <typename T>
+class eytzinger_tree
+{
+private:
+    static const int CACHE_LINE = 64;
+    // descendants of node k four levels down start at data[k * STRIDE]
+    static const int STRIDE = sizeof(T) < CACHE_LINE ? CACHE_LINE / sizeof(T) : 1;
+    // searches advanced together by the batch lookup
+    static const int BATCH = 16;
+
+    // keys at data[1, var_size], data being aligned to a cache line
+    T * data;
+    unsigned char * raw;
+    int var_size;
+    // number of levels, all but the last one full, up to 31, so BFS indices
+    // of nodes, which run past var_size in a search, are long long
+    int levels;
+
+    void prefetch(long long k) const noexcept
+    {
+        // may point past the array, which is harmless for a prefetch
+        __builtin_prefetch(reinterpret_cast<const void *>(
+            reinterpret_cast<std::uintptr_t>(data) + std::uintptr_t(k) * STRIDE * sizeof(T)));
+    }
+    // one step down from node k, going right past the last level
+    long long step(long long k, const T& value) const noexcept
+    {
+        const T& key = data[k <= var_size ? k : var_size];
+        return 2 * k + ((k > var_size) | (key < value));
+    }
+    // the node reached by going left last, or nullptr
+    const T * answer(long long k) const noexcept
+    {
+        k >>= __builtin_ffsll(~k);
+        return k ? data + k : nullptr;
+    }
+public:
+    /**
+    * first: n keys in ascending order
+    */
+    template <typename InputIt>
+    eytzinger_tree(InputIt first, int n);
+    explicit eytzinger_tree(const vector<T> & sorted)
+        : eytzinger_tree(sorted.begin(), sorted.size()) {}
+    eytzinger_tree(const eytzinger_tree &) = delete;
+    eytzinger_tree & operator=(const eytzinger_tree &) = delete;
+    ~eytzinger_tree();
+
+    int size() const noexcept { return var_size; }
+
+    /**
+    * return: the least key not less than value, or nullptr if there is none
+    */
+    const T * lower_bound(const T& value) const noexcept;
+    /**
+    * lower_bound of each of the n values at first into out
+    */
+    void lower_bound(const T * first, int n, const T ** out) const noexcept;
+};
+
+template <typename T>
+    template <typename InputIt>
+eytzinger_tree<T>::eytzinger_tree(InputIt first, int n) : var_size(n), levels(0)
+{
+    raw = new unsigned char [(n + 1LL) * sizeof(T) + CACHE_LINE];
+    std::uintptr_t addr = reinterpret_cast<std::uintptr_t>(raw) + CACHE_LINE - 1;
+    data = reinterpret_cast<T *>(addr - addr % CACHE_LINE);
+    while (n >> levels)
+        ++levels;
+
+    // an inorder walk of the implicit tree takes the keys in ascending order
+    long long k = 1;
+    while (2 * k <= n)
+        k *= 2;
+    for (int i = 0; i < n; ++i, ++first) {
+        new (data + k) T(*first);
+        if (2 * k + 1 <= n) {
+            // next is the leftmost node of the right subtree
+            for (k = 2 * k + 1; 2 * k <= n; k *= 2);
+        }
+        else {
+            // climb while k is a right child, then once more
+            while (k & 1)
+                k >>= 1;
+            k >>= 1;
+        }
+    }
+}
+
+template <typename T>
+eytzinger_tree<T>::~eytzinger_tree()
+{
+    for (long long k = 1; k <= var_size; ++k)
+        data[k].~T();
+    delete []raw;
+}
+
+template <typename T>
+const T * eytzinger_tree<T>::lower_bound(const T& value) const noexcept
+{
+    if (!var_size)
+        return nullptr;
+    long long k = 1;
+    // all levels above the last are full
+    for (int d = 1; d < levels; ++d) {
+        prefetch(k);
+        k = 2 * k + (data[k] < value);
+    }
+    return answer(step(k, value));
+}
+
+template <typename T>
+void eytzinger_tree<T>::lower_bound(const T * first, int n, const T ** out) const noexcept
+{
+    long long k[BATCH];
+    for (int base = 0; base < n; base += BATCH) {
+        const T * value = first + base;
+        int g = n - base < BATCH ? n - base : BATCH;
+        if (!var_size) {
+            for (int j = 0; j < g; ++j)
+                out[base + j] = nullptr;
+            continue;
+        }
+        for (int j = 0; j < g; ++j)
+            k[j] = 1;
+        for (int d = 1; d < levels; ++d)
+            for (int j = 0; j < g; ++j) {
+                prefetch(k[j]);
+                k[j] = 2 * k[j] + (data[k[j]] < value[j]);
+            }
+        for (int j = 0; j < g; ++j)
+            out[base + j] = answer(step(k[j], value[j]));
+    }
+}
+
+/**
+* A sorted array frozen into the van Emde Boas order of a perfect binary
+* search tree, for read-mostly lower_bound queries.
+*
+* A tree of height h is stored as its top h / 2 levels followed by each of
+* the subtrees hanging below them, all laid out the same way recursively. A
+* search then touches O(log_B n) cache lines for any line size B, with no
+* tuning to the cache. The keys are padded with copies of the largest one up
+* to a perfect tree, and a search finds its way with per-depth tables
+* (Brodal, Fagerberg and Jacob) instead of child pointers.
+*/
+template <typename T>
+class veb_tree
+{
+private:
+    static const int CACHE_LINE = 64;
+    static const int MAX_LEVELS = 32;
+    static const int BATCH = 16;
+
+    // keys at data[0, 2^levels - 1), data being aligned to a cache line
+    T * data;
+    unsigned char * raw;
+    int var_size;
+    // up to 31, so BFS indices of nodes, up to 2^levels, are long long
+    int levels;
+    // For a node at depth d, a bottom tree root in the recursive layout:
+    // top_depth[d]: depth of the root of the top tree above it
+    // top_size[d]: number of nodes in that top tree
+    // bottom_size[d]: number of nodes in the tree rooted at the node
+    int top_depth[MAX_LEVELS], top_size[MAX_LEVELS], bottom_size[MAX_LEVELS];
+
+    // fill the tables for a subtree of height h rooted at depth d
+    void split(int h, int d) noexcept;
+    // the position of the node at depth d on the path given by BFS index k,
+    // pos holding the positions of its ancestors
+    int position(const int * pos, int d, long long k) const noexcept
+    {
+        return pos[top_depth[d]] + top_size[d] + (k & top_size[d]) * bottom_size[d];
+    }
+public:
+    /**
+    * first: n keys in ascending order
+    */
+    template <typename RandomIt>
+    veb_tree(RandomIt first, int n);
+    explicit veb_tree(const vector<T> & sorted)
+        : veb_tree(sorted.begin(), sorted.size()) {}
+    veb_tree(const veb_tree &) = delete;
+    veb_tree & operator=(const veb_tree &) = delete;
+    ~veb_tree();
+
+    int size() const noexcept { return var_size; }
+
+    /**
+    * return: the least key not less than value, or nullptr if there is none
+    */
+    const T * lower_bound(const T& value) const noexcept;
+    /**
+    * lower_bound of each of the n values at first into out
+    */
+    void lower_bound(const T * first, int n, const T ** out) const noexcept;
+};
+
+template <typename T>
+void veb_tree<T>::split(int h, int d) noexcept
+{
+    if (h <= 1)
+        return;
+    int t = h / 2;
+    top_depth[d + t] = d;
+    top_size[d + t] = (1 << t) - 1;
+    bottom_size[d + t] = (1 << (h - t)) - 1;
+    split(t, d);
+    split(h - t, d + t);
+}
+
+template <typename T>
+    template <typename RandomIt>
+veb_tree<T>::veb_tree(RandomIt first, int n) : var_size(n), levels(0)
+{
+    while (n >> levels)
+        ++levels;
+    long long full = (1LL << levels) - 1;
+    raw = new unsigned char [full * sizeof(T) + CACHE_LINE];
+    std::uintptr_t addr = reinterpret_cast<std::uintptr_t>(raw) + CACHE_LINE - 1;
+    data = reinterpret_cast<T *>(addr - addr % CACHE_LINE);
+    split(levels, 0);
+
+    int pos[MAX_LEVELS];
+    pos[0] = 0;
+    for (long long k = 1; k <= full; ++k) {
+        int depth = 63 - __builtin_clzll(k);
+        // positions of the ancestors on the path to k
+        for (int d = 1; d <= depth; ++d)
+            pos[d] = position(pos, d, k >> (depth - d));
+        // the rank of node k in an inorder walk
+        long long rank = (((k - (1LL << depth)) * 2 + 1) << (levels - depth - 1)) - 1;
+        new (data + pos[depth]) T(first[rank < n ? rank : n - 1]);
+    }
+}
+
+template <typename T>
+veb_tree<T>::~veb_tree()
+{
+    for (long long i = 0; i < (1LL << levels) - 1; ++i)
+        data[i].~T();
+    delete []raw;
+}
+
+template <typename T>
+const T * veb_tree<T>::lower_bound(const T& value) const noexcept
+{
+    int pos[MAX_LEVELS + 1];
+    pos[0] = 0;
+    long long k = 1;
+    for (int d = 0; d < levels; ++d) {
+        if (d)
+            pos[d] = position(pos, d, k);
+        k = 2 * k + (data[pos[d]] < value);
+    }
+    // the node reached by going left last
+    int d = levels - __builtin_ffsll(~k);
+    return d >= 0 ? data + pos[d] : nullptr;
+}
+
+template <typename T>
+void veb_tree<T>::lower_bound(const T * first, int n, const T ** out) const noexcept
+{
+    int pos[BATCH][MAX_LEVELS + 1];
+    long long k[BATCH];
+    for (int base = 0; base < n; base += BATCH) {
+        const T * value = first + base;
+        int g = n - base < BATCH ? n - base : BATCH;
+        for (int j = 0; j < g; ++j) {
+            pos[j][0] = 0;
+            k[j] = 1;
+        }
+        for (int d = 0; d < levels; ++d)
+            for (int j = 0; j < g; ++j) {
+                if (d)
+                    pos[j][d] = position(pos[j], d, k[j]);
+                k[j] = 2 * k[j] + (data[pos[j][d]] < value[j]);
+            }
+        for (int j = 0; j < g; ++j) {
+            int d = levels - __builtin_ffsll(~k[j]);
+            out[base + j] = d >= 0 ? data + pos[j][d] : nullptr;
+        }
+    }
+}
+
+}
+
+#endif // STATIC_SEARCH_TREE_H_
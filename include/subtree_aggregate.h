@@ -0,0 +1,160 @@
+#ifndef SUBTREE_AGGREGATE_H_
+#define SUBTREE_AGGREGATE_H_
+
+#include <cstddef>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include "linked_binary_tree.h"
+
+namespace sx
+{
+
+/**
+* Aggregates for subtree_aggregates. Each one is a monoid over subtrees:
+* identity() is the value of an empty subtree and make(key, l, r) the value
+* of a subtree from the key at its root and the values of its two subtrees.
+*/
+struct subtree_size
+{
+    typedef int value_type;
+
+    static int identity() noexcept { return 0; }
+    template <typename T>
+    static int make(const T&, int l, int r) noexcept { return l + r + 1; }
+};
+
+struct subtree_height
+{
+    typedef int value_type;
+
+    static int identity() noexcept { return 0; }
+    template <typename T>
+    static int make(const T&, int l, int r) noexcept { return (l > r ? l : r) + 1; }
+};
+
+template <typename S = long long>
+struct subtree_sum
+{
+    typedef S value_type;
+
+    static S identity() { return S(); }
+    template <typename T>
+    static S make(const T& key, const S& l, const S& r) { return l + r + S(key); }
+};
+
+/**
+* Cached aggregates of every subtree of a tree whose nodes are in one array,
+* e.g. from linked_binary_tree::link_nodes, such as
+*     subtree_aggregates<int, subtree_size, subtree_height> a(t, nodes, n);
+*     a.get<subtree_height>(u);
+*
+* All aggregates are computed together in one postorder walk and kept in a
+* side array by node index, so a query is a lookup. When a subtree is
+* moved through relink, only the values on the paths up to the root are
+* computed again.
+*/
+template <typename T, typename... Aggregates>
+class subtree_aggregates
+{
+private:
+    typedef typename linked_binary_tree<T>::node node;
+    typedef std::tuple<typename Aggregates::value_type...> value_type;
+    typedef std::index_sequence_for<Aggregates...> indices;
+
+    // the position of A in Aggregates
+    template <typename A, std::size_t I = 0, typename First = void, typename... Rest>
+    struct index_of;
+    template <typename A, std::size_t I, typename... Rest>
+    struct index_of<A, I, A, Rest...> : std::integral_constant<std::size_t, I> {};
+    template <typename A, std::size_t I, typename First, typename... Rest>
+    struct index_of : index_of<A, I + 1, Rest...> {};
+
+    node * nodes;
+    value_type * values;
+
+    int id(const node * u) const noexcept { return int(u - nodes); }
+    template <std::size_t... I>
+    void compute(const node * u, std::index_sequence<I...>);
+    // compute the values of u from those of its children
+    void compute(const node * u) { compute(u, indices()); }
+public:
+    /**
+    * t: the tree, rooted in the array
+    * nodes_: the array of nodes
+    * n: the size of the array
+    */
+    subtree_aggregates(linked_binary_tree<T> & t, node * nodes_, int n);
+    subtree_aggregates(const subtree_aggregates &) = delete;
+    subtree_aggregates & operator=(const subtree_aggregates &) = delete;
+    ~subtree_aggregates() { delete []values; }
+
+    template <typename A>
+    const typename A::value_type & get(const node * u) const noexcept
+    {
+        return std::get<index_of<A, 0, Aggregates...>::value>(values[id(u)]);
+    }
+
+    /**
+    * Make child the left (or right) child of parent, in place of the
+    * subtree there, which is cut off. child is first cut from its own
+    * parent, if any. Both parents and their ancestors are updated.
+    */
+    void relink(node * parent, node * child, bool left);
+    /**
+    * Compute again the values of u and its ancestors, after the subtree of u
+    * changed other than through relink.
+    */
+    void update(node * u);
+};
+
+template <typename T, typename... Aggregates>
+    template <std::size_t... I>
+void subtree_aggregates<T, Aggregates...>::compute(const node * u,
+                                                   std::index_sequence<I...>)
+{
+    value_type & v = values[id(u)];
+    // one make per aggregate, each with the values of the children
+    ((std::get<I>(v) = Aggregates::make(u->key,
+        u->left ? std::get<I>(values[id(u->left)]) : Aggregates::identity(),
+        u->right ? std::get<I>(values[id(u->right)]) : Aggregates::identity())), ...);
+}
+
+template <typename T, typename... Aggregates>
+subtree_aggregates<T, Aggregates...>::subtree_aggregates(
+        linked_binary_tree<T> & t, node * nodes_, int n)
+    : nodes(nodes_), values(new value_type [n])
+{
+    // children come before parents in a postorder walk
+    for (auto i = t.begin_post(); i != t.end_post(); ++i)
+        compute(*i);
+}
+
+template <typename T, typename... Aggregates>
+void subtree_aggregates<T, Aggregates...>::update(node * u)
+{
+    for (; u; u = u->p)
+        compute(u);
+}
+
+template <typename T, typename... Aggregates>
+void subtree_aggregates<T, Aggregates...>::relink(node * parent, node * child, bool left)
+{
+    if (child && child->p) {
+        node * old = child->p;
+        (old->left == child ? old->left : old->right) = nullptr;
+        child->p = nullptr;
+        update(old);
+    }
+    node *& link = left ? parent->left : parent->right;
+    if (link)
+        link->p = nullptr;
+    link = child;
+    if (child)
+        child->p = parent;
+    update(parent);
+}
+
+}
+
+#endif // SUBTREE_AGGREGATE_H_
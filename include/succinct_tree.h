@@ -0,0 +1,582 @@
+#ifndef SUCCINCT_TREE_H_
+#define SUCCINCT_TREE_H_
+
+#include <climits>
+#include <cstddef>
+#include "vector.h"
+#include "stack.h"
+#include "chunked_array.h"
+#include "linked_binary_tree.h"
+
+namespace sx
+{
+
+/**
+* A binary tree in about 2.4 bits per node plus its keys, for keeping many
+* tree shapes in memory where linked_binary_tree spends three pointers per
+* node.
+*
+* The binary tree is read as a forest (left child = first child, right child
+* = next sibling) under an extra root, and the forest is written as balanced
+* parentheses, 1 for an opening and 0 for a closing one: 2n + 2 bits. A node
+* is the position of its opening parenthesis, and nodes are numbered in
+* preorder, which is the same in both trees. Keys are kept in a plain array
+* in that order.
+*
+* Navigation reduces to rank over the bits and to searching the excess
+* (opens minus closes) for a given value forward or backward, e.g. the match
+* of an opening parenthesis is the first later position where the excess
+* falls back. Searches scan within a 512-bit block a byte at a time, and
+* skip blocks with a tree over the least excess of every block, so each
+* takes O(log n).
+*/
+template <typename T>
+class succinct_binary_tree
+{
+public:
+    typedef int handle;
+    static const handle NONE = -1;
+private:
+    typedef typename linked_binary_tree<T>::node node;
+    static const int BLOCK = 512;
+
+    // excess of a byte read from its low bit up, and of its prefixes
+    struct byte_table
+    {
+        signed char total[256], fwd_min[256], bwd_min[256];
+
+        byte_table() noexcept;
+    };
+    static const byte_table & table()
+    {
+        static const byte_table t;
+        return t;
+    }
+
+    vector<unsigned long long> bits;
+    int n_bits;
+    // ones before each block
+    vector<int> block_rank;
+    // a segment tree over the least excess at the positions bounding each
+    // block, min_tree[leaves + k] for block k
+    vector<int> min_tree;
+    int leaves;
+    // keys in preorder, empty for a shape only
+    vector<T> keys;
+
+    void push_bit(bool b);
+    void build_index();
+
+    bool bit(int p) const noexcept { return bits[p >> 6] >> (p & 63) & 1; }
+    int byte(int p) const noexcept { return bits[p >> 6] >> (p & 63) & 0xff; }
+    // number of ones in [0, p)
+    int rank1(int p) const noexcept;
+    // position of the k-th one, counting from 1
+    int select1(int k) const noexcept;
+    // opens minus closes in [0, p)
+    int excess(int p) const noexcept { return 2 * rank1(p) - p; }
+    int next_block(int k, int target) const noexcept;
+    int prev_block(int k, int target) const noexcept;
+    bool scan_fwd(int & p, int & x, int end, int target) const noexcept;
+    bool scan_bwd(int & p, int & x, int start, int target) const noexcept;
+    // the least p > s with excess(p) <= target, or NONE
+    int fwd(int s, int target) const noexcept;
+    // the greatest p < s with excess(p) <= target, or NONE
+    int bwd(int s, int target) const noexcept;
+
+    int find_close(int i) const noexcept { return fwd(i, excess(i)) - 1; }
+    int find_open(int j) const noexcept { return bwd(j + 1, excess(j + 1)); }
+    // the opening parenthesis of the forest parent of i
+    int enclose(int i) const noexcept { return bwd(i, excess(i) - 1); }
+public:
+    /**
+    * Encode the tree rooted at root, nullptr for an empty tree.
+    */
+    explicit succinct_binary_tree(const node * root);
+    /**
+    * Encode a tree given as arrays of children, as in the input of
+    * linked_binary_tree::link_nodes.
+    *
+    * left, right: left[i] and right[i] are the children of the i-th node,
+    * numbered from 1, with 0 for no child
+    * n: the number of nodes
+    * key: the key of the i-th node at key[i], or nullptr for a shape only
+    */
+    succinct_binary_tree(const int * left, const int * right, int n,
+                         const T * key = nullptr);
+
+    int size() const noexcept { return n_bits / 2 - 1; }
+    // bytes taken by the shape and its index, without the keys
+    std::size_t shape_bytes() const noexcept
+    {
+        return sizeof(unsigned long long) * bits.size()
+            + sizeof(int) * (block_rank.size() + min_tree.size());
+    }
+
+    handle root() const noexcept { return n_bits > 2 ? 1 : NONE; }
+    handle left(handle v) const noexcept { return bit(v + 1) ? v + 1 : NONE; }
+    handle right(handle v) const noexcept
+    {
+        int j = find_close(v) + 1;
+        return bit(j) ? j : NONE;
+    }
+    handle parent(handle v) const noexcept
+    {
+        // v is either the first child of its forest parent or the next
+        // sibling of the node closed just before it
+        if (bit(v - 1))
+            return v - 1 ? v - 1 : NONE;
+        return find_open(v - 1);
+    }
+    // the number of nodes in the subtree rooted at v, v included
+    int subtree_size(handle v) const noexcept
+    {
+        // the subtree is v with all its later forest siblings, up to the
+        // closing parenthesis of their forest parent
+        return (find_close(enclose(v)) - v) / 2;
+    }
+    // position of v in preorder, counting from 0
+    int index(handle v) const noexcept { return rank1(v) - 1; }
+    handle at(int k) const noexcept { return select1(k + 2); }
+    const T& key(handle v) const noexcept { return keys[index(v)]; }
+
+    // keys in preorder
+    const T * begin_pre() const noexcept { return keys.begin(); }
+    const T * end_pre() const noexcept { return keys.end(); }
+
+    class node_iterator_in
+    {
+    private:
+        const succinct_binary_tree * t;
+        // a closing parenthesis, closing nodes in inorder
+        int j;
+    public:
+        node_iterator_in(const succinct_binary_tree * t_, int j_) noexcept
+            : t(t_), j(j_) {}
+
+        handle operator*() const noexcept { return t->find_open(j); }
+        node_iterator_in & operator++() noexcept;
+        bool operator==(const node_iterator_in & i) const noexcept { return j == i.j; }
+        bool operator!=(const node_iterator_in & i) const noexcept { return j != i.j; }
+    };
+
+    class node_iterator_post
+    {
+    private:
+        struct frame
+        {
+            handle v;
+            bool going_right;
+
+            frame(handle v_) : v(v_), going_right(true) {}
+        };
+        const succinct_binary_tree * t;
+        stack<frame, chunked_array<frame>> s;
+
+        void find_first(handle v);
+    public:
+        node_iterator_post(const succinct_binary_tree * t_, handle root) : t(t_)
+        {
+            if (root != NONE)
+                find_first(root);
+        }
+
+        handle operator*() const noexcept { return s.top().v; }
+        node_iterator_post & operator++();
+        bool operator==(const node_iterator_post & i) const noexcept
+        {
+            return s.empty() && i.s.empty();
+        }
+        bool operator!=(const node_iterator_post & i) const noexcept
+        {
+            return !(*this == i);
+        }
+    };
+
+    // inorder walk, in the order of closing parentheses
+    node_iterator_in begin_in() const noexcept
+    {
+        int j = 1;
+        while (j < n_bits - 1 && bit(j))
+            ++j;
+        return node_iterator_in(this, j);
+    }
+    node_iterator_in end_in() const noexcept { return node_iterator_in(this, n_bits - 1); }
+    node_iterator_post begin_post() const { return node_iterator_post(this, root()); }
+    node_iterator_post end_post() const { return node_iterator_post(this, NONE); }
+
+    /**
+    * Decode into nodes created with new, as from create_root.
+    *
+    * return: the root, or nullptr for an empty tree
+    */
+    node * to_linked() const;
+    /**
+    * Decode into arrays of children as taken by the constructor, the i-th
+    * node being the i-th in preorder.
+    *
+    * key: receives the keys if not nullptr
+    */
+    void to_arrays(int * left, int * right, T * key = nullptr) const;
+};
+
+template <typename T>
+succinct_binary_tree<T>::byte_table::byte_table() noexcept
+{
+    for (int b = 0; b < 256; ++b) {
+        int x = 0, least = INT_MAX;
+        for (int i = 0; i < 8; ++i) {
+            x += b >> i & 1 ? 1 : -1;
+            if (x < least)
+                least = x;
+        }
+        total[b] = x;
+        fwd_min[b] = least;
+        x = 0;
+        least = INT_MAX;
+        for (int i = 7; i >= 0; --i) {
+            x -= b >> i & 1 ? 1 : -1;
+            if (x < least)
+                least = x;
+        }
+        bwd_min[b] = least;
+    }
+}
+
+template <typename T>
+void succinct_binary_tree<T>::push_bit(bool b)
+{
+    if (!(n_bits & 63))
+        bits.push_back(0);
+    if (b)
+        bits.back() |= 1ULL << (n_bits & 63);
+    ++n_bits;
+}
+
+template <typename T>
+void succinct_binary_tree<T>::build_index()
+{
+    int n_blocks = n_bits / BLOCK + 1;
+    for (leaves = 1; leaves < n_blocks; leaves *= 2);
+    for (int i = 0; i < 2 * leaves; ++i)
+        min_tree.push_back(INT_MAX);
+
+    int ones = 0, x = 0;
+    for (int k = 0; k < n_blocks; ++k) {
+        block_rank.push_back(ones);
+        int start = k * BLOCK, end = start + BLOCK < n_bits ? start + BLOCK : n_bits;
+        int least = x;
+        for (int p = start; p < end; ++p) {
+            ones += bit(p);
+            x += bit(p) ? 1 : -1;
+            if (x < least)
+                least = x;
+        }
+        min_tree[leaves + k] = least;
+    }
+    for (int v = leaves - 1; v > 0; --v)
+        min_tree[v] = min_tree[2 * v] < min_tree[2 * v + 1] ? min_tree[2 * v] : min_tree[2 * v + 1];
+}
+
+template <typename T>
+succinct_binary_tree<T>::succinct_binary_tree(const node * root) : n_bits(0)
+{
+    stack<const node *, chunked_array<const node *>> s;
+    const node * v = root;
+    // the extra root
+    push_bit(1);
+    while (true) {
+        // open v and its chain of left children, its forest descendants
+        for (; v; v = v->left) {
+            push_bit(1);
+            keys.push_back(v->key);
+            s.push(v);
+        }
+        if (s.empty())
+            break;
+        // close the last node opened and go on with its next sibling
+        push_bit(0);
+        v = s.top()->right;
+        s.pop();
+    }
+    push_bit(0);
+    build_index();
+}
+
+template <typename T>
+succinct_binary_tree<T>::succinct_binary_tree(const int * left, const int * right,
+                                              int n, const T * key)
+    : n_bits(0)
+{
+    // the root is the only node that is no one's child
+    long long root = (long long)n * (n + 1) / 2;
+    for (int i = 0; i < n; ++i)
+        root -= left[i] + right[i];
+
+    stack<int, chunked_array<int>> s;
+    int v = n ? int(root) : 0;
+    push_bit(1);
+    while (true) {
+        for (; v; v = left[v - 1]) {
+            push_bit(1);
+            if (key)
+                keys.push_back(key[v - 1]);
+            s.push(v);
+        }
+        if (s.empty())
+            break;
+        push_bit(0);
+        v = right[s.top() - 1];
+        s.pop();
+    }
+    push_bit(0);
+    build_index();
+}
+
+template <typename T>
+int succinct_binary_tree<T>::rank1(int p) const noexcept
+{
+    int k = p / BLOCK, r = block_rank[k];
+    for (int w = k * (BLOCK / 64); w < p >> 6; ++w)
+        r += __builtin_popcountll(bits[w]);
+    if (p & 63)
+        r += __builtin_popcountll(bits[p >> 6] & ((1ULL << (p & 63)) - 1));
+    return r;
+}
+
+template <typename T>
+int succinct_binary_tree<T>::select1(int k) const noexcept
+{
+    // the last block with fewer than k ones before it
+    int lo = 0, hi = block_rank.size() - 1, mid;
+    while (lo < hi) {
+        mid = (lo + hi + 1) / 2;
+        if (block_rank[mid] < k)
+            lo = mid;
+        else
+            hi = mid - 1;
+    }
+    k -= block_rank[lo];
+    int w = lo * (BLOCK / 64), c;
+    while ((c = __builtin_popcountll(bits[w])) < k) {
+        k -= c;
+        ++w;
+    }
+    unsigned long long word = bits[w];
+    // drop the lowest k - 1 ones
+    while (--k)
+        word &= word - 1;
+    return w * 64 + __builtin_ctzll(word);
+}
+
+template <typename T>
+int succinct_binary_tree<T>::next_block(int k, int target) const noexcept
+{
+    if (k >= leaves)
+        return NONE;
+    int v = leaves + k;
+    while (min_tree[v] > target) {
+        // climb while v is a right child, then go to the right sibling
+        while (v & 1) {
+            if (v == 1)
+                return NONE;
+            v >>= 1;
+        }
+        ++v;
+    }
+    while (v < leaves)
+        v = min_tree[2 * v] <= target ? 2 * v : 2 * v + 1;
+    return v - leaves;
+}
+
+template <typename T>
+int succinct_binary_tree<T>::prev_block(int k, int target) const noexcept
+{
+    if (k < 0)
+        return NONE;
+    int v = leaves + k;
+    while (min_tree[v] > target) {
+        // climb while v is a left child, then go to the left sibling
+        while (!(v & 1))
+            v >>= 1;
+        if (v == 1)
+            return NONE;
+        --v;
+    }
+    while (v < leaves)
+        v = min_tree[2 * v + 1] <= target ? 2 * v + 1 : 2 * v;
+    return v - leaves;
+}
+
+template <typename T>
+bool succinct_binary_tree<T>::scan_fwd(int & p, int & x, int end, int target) const noexcept
+{
+    const byte_table & tb = table();
+    while (p < end && (p & 7)) {
+        x += bit(p++) ? 1 : -1;
+        if (x <= target)
+            return true;
+    }
+    // whole bytes, as long as the target is not reached within one
+    for (int b; p + 8 <= end && x + tb.fwd_min[b = byte(p)] > target; p += 8)
+        x += tb.total[b];
+    while (p < end) {
+        x += bit(p++) ? 1 : -1;
+        if (x <= target)
+            return true;
+    }
+    return false;
+}
+
+template <typename T>
+bool succinct_binary_tree<T>::scan_bwd(int & p, int & x, int start, int target) const noexcept
+{
+    const byte_table & tb = table();
+    while (p > start && (p & 7)) {
+        x -= bit(--p) ? 1 : -1;
+        if (x <= target)
+            return true;
+    }
+    for (int b; p - 8 >= start && x + tb.bwd_min[b = byte(p - 8)] > target; p -= 8)
+        x -= tb.total[b];
+    while (p > start) {
+        x -= bit(--p) ? 1 : -1;
+        if (x <= target)
+            return true;
+    }
+    return false;
+}
+
+template <typename T>
+int succinct_binary_tree<T>::fwd(int s, int target) const noexcept
+{
+    int k = s / BLOCK, p = s, x = excess(s);
+    if (scan_fwd(p, x, (k + 1) * BLOCK < n_bits ? (k + 1) * BLOCK : n_bits, target))
+        return p;
+    if ((k = next_block(k + 1, target)) == NONE)
+        return NONE;
+    p = k * BLOCK;
+    x = excess(p);
+    scan_fwd(p, x, (k + 1) * BLOCK < n_bits ? (k + 1) * BLOCK : n_bits, target);
+    return p;
+}
+
+template <typename T>
+int succinct_binary_tree<T>::bwd(int s, int target) const noexcept
+{
+    if (!s)
+        return NONE;
+    int k = (s - 1) / BLOCK, p = s, x = excess(s);
+    if (scan_bwd(p, x, k * BLOCK, target))
+        return p;
+    if ((k = prev_block(k - 1, target)) == NONE)
+        return NONE;
+    p = (k + 1) * BLOCK;
+    x = excess(p);
+    scan_bwd(p, x, k * BLOCK, target);
+    return p;
+}
+
+template <typename T>
+typename succinct_binary_tree<T>::node_iterator_in &
+succinct_binary_tree<T>::node_iterator_in::operator++() noexcept
+{
+    // the next closing parenthesis
+    int w = (j + 1) >> 6;
+    unsigned long long zeros = ~t->bits[w] & (~0ULL << ((j + 1) & 63));
+    while (!zeros)
+        zeros = ~t->bits[++w];
+    j = w * 64 + __builtin_ctzll(zeros);
+    return *this;
+}
+
+template <typename T>
+void succinct_binary_tree<T>::node_iterator_post::find_first(handle v)
+{
+    handle c;
+    while (true) {
+        s.push(v);
+        if ((c = t->left(v)) != NONE)
+            v = c;
+        else if ((c = t->right(v)) != NONE) {
+            s.top().going_right = false;
+            v = c;
+        }
+        else
+            break;
+    }
+    s.top().going_right = false;
+}
+
+template <typename T>
+typename succinct_binary_tree<T>::node_iterator_post &
+succinct_binary_tree<T>::node_iterator_post::operator++()
+{
+    s.pop();
+    if (!s.empty() && s.top().going_right) {
+        s.top().going_right = false;
+        handle r = t->right(s.top().v);
+        if (r != NONE)
+            find_first(r);
+    }
+    return *this;
+}
+
+template <typename T>
+typename succinct_binary_tree<T>::node * succinct_binary_tree<T>::to_linked() const
+{
+    // Read the parentheses in order: an opening one after an opening one is
+    // a left child, after a closing one the right child of the node closed.
+    stack<node *, chunked_array<node *>> s;
+    node * root = nullptr, * closed = nullptr, * v;
+    int k = 0;
+    for (int p = 1; p < n_bits - 1; ++p)
+        if (bit(p)) {
+            v = keys.size() ? new node(keys[k++]) : new node;
+            if (p == 1)
+                root = v;
+            else if (bit(p - 1)) {
+                v->p = s.top();
+                s.top()->left = v;
+            }
+            else {
+                v->p = closed;
+                closed->right = v;
+            }
+            s.push(v);
+        }
+        else {
+            closed = s.top();
+            s.pop();
+        }
+    return root;
+}
+
+template <typename T>
+void succinct_binary_tree<T>::to_arrays(int * left, int * right, T * key) const
+{
+    stack<int, chunked_array<int>> s;
+    int closed = 0, k = 0;
+    for (int p = 1; p < n_bits - 1; ++p)
+        if (bit(p)) {
+            left[k] = right[k] = 0;
+            if (key && keys.size())
+                key[k] = keys[k];
+            ++k;
+            if (p == 1)
+                ;
+            else if (bit(p - 1))
+                left[s.top() - 1] = k;
+            else
+                right[closed - 1] = k;
+            s.push(k);
+        }
+        else {
+            closed = s.top();
+            s.pop();
+        }
+}
+
+}
+
+#endif // SUCCINCT_TREE_H_
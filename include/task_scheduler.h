@@ -0,0 +1,362 @@
+#ifndef TASK_SCHEDULER_H_
+#define TASK_SCHEDULER_H_
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include "queue.h"
+#include "vector.h"
+
+namespace sx
+{
+
+/**
+* A unit of work run by the scheduler. done is set once run() returns.
+*/
+class task
+{
+public:
+    std::atomic<bool> done;
+
+    task() noexcept : done(false) {}
+    virtual ~task() = default;
+    virtual void run() = 0;
+};
+
+template <typename F>
+class function_task : public task
+{
+private:
+    F f;
+public:
+    function_task(F f_) : f(std::move(f_)) {}
+
+    void run() override { f(); }
+};
+
+/**
+* A Chase-Lev work-stealing deque of tasks (Le et al., "Correct and Efficient
+* Work-Stealing for Weak Memory Models"). The owner pushes and pops at the
+* bottom like a stack, while other threads steal from the top.
+*
+* The ring grows when full. Old rings may still be read by a thief and are
+* only freed in the destructor.
+*/
+class work_stealing_deque
+{
+private:
+    struct ring
+    {
+        long capacity;
+        std::atomic<task *> * slots;
+
+        ring(long capacity_)
+            : capacity(capacity_), slots(new std::atomic<task *> [capacity_]) {}
+        ~ring() { delete []slots; }
+
+        task * get(long i) const noexcept
+        {
+            return slots[i & (capacity - 1)].load(std::memory_order_relaxed);
+        }
+        void put(long i, task * t) noexcept
+        {
+            slots[i & (capacity - 1)].store(t, std::memory_order_relaxed);
+        }
+    };
+
+    alignas(64) std::atomic<long> top;
+    alignas(64) std::atomic<long> bottom;
+    std::atomic<ring *> r;
+    vector<ring *> retired;
+public:
+    work_stealing_deque() : top(0), bottom(0), r(new ring(256)) {}
+    work_stealing_deque(const work_stealing_deque &) = delete;
+    work_stealing_deque & operator=(const work_stealing_deque &) = delete;
+    ~work_stealing_deque();
+
+    // owner only
+    void push(task * t);
+    task * pop() noexcept;
+    // any thread, nullptr if empty or lost a race
+    task * steal() noexcept;
+};
+
+inline work_stealing_deque::~work_stealing_deque()
+{
+    delete r.load(std::memory_order_relaxed);
+    for (ring * old : retired)
+        delete old;
+}
+
+inline void work_stealing_deque::push(task * t)
+{
+    long b = bottom.load(std::memory_order_relaxed);
+    long tp = top.load(std::memory_order_acquire);
+    ring * a = r.load(std::memory_order_relaxed);
+    if (b - tp > a->capacity - 1) {
+        ring * bigger = new ring(2 * a->capacity);
+        for (long i = tp; i < b; ++i)
+            bigger->put(i, a->get(i));
+        retired.push_back(a);
+        r.store(a = bigger, std::memory_order_release);
+    }
+    a->put(b, t);
+    bottom.store(b + 1, std::memory_order_release);
+}
+
+inline task * work_stealing_deque::pop() noexcept
+{
+    long b = bottom.load(std::memory_order_relaxed) - 1;
+    ring * a = r.load(std::memory_order_relaxed);
+    bottom.store(b, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    long tp = top.load(std::memory_order_relaxed);
+    task * t = nullptr;
+    if (tp <= b) {
+        t = a->get(b);
+        if (tp == b) {
+            // the last task, race against thieves for it
+            if (!top.compare_exchange_strong(tp, tp + 1,
+                    std::memory_order_seq_cst, std::memory_order_relaxed))
+                t = nullptr;
+            bottom.store(b + 1, std::memory_order_relaxed);
+        }
+    }
+    else
+        bottom.store(b + 1, std::memory_order_relaxed);
+    return t;
+}
+
+inline task * work_stealing_deque::steal() noexcept
+{
+    long tp = top.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    long b = bottom.load(std::memory_order_acquire);
+    if (tp < b) {
+        task * t = r.load(std::memory_order_acquire)->get(tp);
+        if (top.compare_exchange_strong(tp, tp + 1,
+                std::memory_order_seq_cst, std::memory_order_relaxed))
+            return t;
+    }
+    return nullptr;
+}
+
+/**
+* A pool of worker threads, each with its own work-stealing deque, running
+* fork/join parallel code.
+*
+* fork_join(f1, f2) called on a worker pushes f2 to the worker's deque, runs
+* f1 and then pops f2 back, unless an idle worker stole it meanwhile, in which
+* case the caller runs other tasks until f2 completes. Called from any other
+* thread, fork_join hands itself to the pool and blocks until done.
+*
+* Forking is only worth it for large pieces of work, so callers are expected
+* to fall back to sequential code below some grain size.
+*/
+class task_scheduler
+{
+private:
+    struct worker
+    {
+        task_scheduler * owner;
+        work_stealing_deque d;
+        unsigned seed;
+    };
+
+    int n_workers;
+    worker * workers;
+    std::thread * threads;
+
+    // tasks submitted from threads outside the pool
+    std::mutex m;
+    std::condition_variable cv;
+    queue<task *> injected;
+    std::atomic<bool> stopping;
+    std::atomic<int> sleepers;
+
+    static worker *& current() noexcept
+    {
+        static thread_local worker * w = nullptr;
+        return w;
+    }
+
+    void work(worker * w);
+    task * find_task(worker * w);
+    void wake();
+    void run_external(task * t);
+public:
+    /**
+    * n_workers_: number of threads, defaulting to the number of cores
+    */
+    explicit task_scheduler(int n_workers_ = 0);
+    task_scheduler(const task_scheduler &) = delete;
+    task_scheduler & operator=(const task_scheduler &) = delete;
+    ~task_scheduler();
+
+    /**
+    * The pool shared by all parallel algorithms so that they do not
+    * oversubscribe the cores.
+    */
+    static task_scheduler & instance();
+
+    int size() const noexcept { return n_workers; }
+    /**
+    * return: the index in [0, size()) of the worker running the caller, or
+    * -1 for a thread outside the pool, e.g. to pick per-worker state
+    */
+    int worker_index() const noexcept
+    {
+        worker * w = current();
+        return w && w->owner == this ? int(w - workers) : -1;
+    }
+
+    /**
+    * Run f1 and f2, possibly in parallel, and return when both are done.
+    */
+    template <typename F1, typename F2>
+    void fork_join(F1&& f1, F2&& f2);
+};
+
+inline task_scheduler::task_scheduler(int n_workers_)
+    : n_workers(n_workers_ > 0 ? n_workers_
+        : int(std::thread::hardware_concurrency())),
+    stopping(false), sleepers(0)
+{
+    if (n_workers < 1)
+        n_workers = 1;
+    workers = new worker [n_workers];
+    threads = new std::thread [n_workers];
+    for (int i = 0; i < n_workers; ++i) {
+        workers[i].owner = this;
+        workers[i].seed = i + 1;
+    }
+    for (int i = 0; i < n_workers; ++i)
+        threads[i] = std::thread(&task_scheduler::work, this, &workers[i]);
+}
+
+inline task_scheduler::~task_scheduler()
+{
+    {
+        std::lock_guard<std::mutex> lock(m);
+        stopping.store(true);
+    }
+    cv.notify_all();
+    for (int i = 0; i < n_workers; ++i)
+        threads[i].join();
+    delete []threads;
+    delete []workers;
+}
+
+inline task_scheduler & task_scheduler::instance()
+{
+    static task_scheduler s;
+    return s;
+}
+
+inline task * task_scheduler::find_task(worker * w)
+{
+    task * t = w->d.pop();
+    if (t)
+        return t;
+    // steal from a random victim first, then sweep the rest
+    w->seed = w->seed * 1103515245 + 12345;
+    int start = (w->seed >> 16) % n_workers;
+    for (int i = 0; i < n_workers; ++i) {
+        worker * victim = &workers[(start + i) % n_workers];
+        if (victim != w && (t = victim->d.steal()))
+            return t;
+    }
+    std::lock_guard<std::mutex> lock(m);
+    if (!injected.empty()) {
+        t = injected.front();
+        injected.pop();
+    }
+    return t;
+}
+
+inline void task_scheduler::work(worker * w)
+{
+    current() = w;
+    int idle = 0;
+    task * t;
+    while (!stopping.load(std::memory_order_acquire)) {
+        if ((t = find_task(w))) {
+            t->run();
+            t->done.store(true, std::memory_order_release);
+            idle = 0;
+        }
+        else if (++idle < 64)
+            std::this_thread::yield();
+        else {
+            // Sleep until woken by new work. The timeout bounds the delay
+            // should a wake-up race with going to sleep.
+            sleepers.fetch_add(1);
+            {
+                std::unique_lock<std::mutex> lock(m);
+                if (injected.empty() && !stopping.load())
+                    cv.wait_for(lock, std::chrono::milliseconds(1));
+            }
+            sleepers.fetch_sub(1);
+            idle = 0;
+        }
+    }
+    current() = nullptr;
+}
+
+inline void task_scheduler::wake()
+{
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (sleepers.load(std::memory_order_relaxed))
+        cv.notify_one();
+}
+
+inline void task_scheduler::run_external(task * t)
+{
+    {
+        std::lock_guard<std::mutex> lock(m);
+        injected.push(t);
+    }
+    cv.notify_one();
+    while (!t->done.load(std::memory_order_acquire))
+        std::this_thread::yield();
+}
+
+template <typename F1, typename F2>
+void task_scheduler::fork_join(F1&& f1, F2&& f2)
+{
+    worker * w = current();
+    if (!w || w->owner != this) {
+        auto g = [this, &f1, &f2] { fork_join(f1, f2); };
+        function_task<decltype(g)> whole(g);
+        run_external(&whole);
+        return;
+    }
+
+    auto g = [&f2] { f2(); };
+    function_task<decltype(g)> forked(g);
+    w->d.push(&forked);
+    wake();
+    f1();
+    // Every task pushed after forked has been joined by now, so the deque
+    // yields either forked or nothing if it was stolen.
+    if (w->d.pop() == &forked)
+        forked.run();
+    else
+        // help with other work instead of blocking until the thief finishes
+        while (!forked.done.load(std::memory_order_acquire)) {
+            task * t = w->owner->find_task(w);
+            if (t) {
+                t->run();
+                t->done.store(true, std::memory_order_release);
+            }
+            else
+                std::this_thread::yield();
+        }
+}
+
+}
+
+#endif // TASK_SCHEDULER_H_
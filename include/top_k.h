@@ -0,0 +1,170 @@
+#ifndef TOP_K_H_
+#define TOP_K_H_
+
+#include <type_traits>
+#include "min_heap.h"
+#include "task_scheduler.h"
+#include "vector.h"
+#if defined(__SSE2__) || defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+namespace sx
+{
+
+/**
+* Keep the k largest of a stream of values in O(k) memory.
+*
+* The values kept are in a min_heap of at most k elements whose top is the
+* threshold: a new value enters only if it is greater, replacing the top.
+* Once the heap is full, nearly all values of a long stream are rejected by
+* that one comparison. push(first, n) compares whole blocks of int or float
+* values against the threshold with SIMD and only looks at the few that
+* pass.
+*
+* Selectors filled by different threads can be combined with merge.
+*/
+template <typename T, int D = 4>
+class top_k
+{
+private:
+    int k;
+    min_heap<T, D> h;
+
+    template <typename Local>
+    static void split(const T * first, long n, long grain, Local * locals);
+public:
+    explicit top_k(int k_ = 0) : k(k_) {}
+
+    int capacity() const noexcept { return k; }
+    int size() const noexcept { return h.size(); }
+    bool full() const noexcept { return h.size() == k; }
+    /**
+    * The least value kept, which a value must exceed to get in once full.
+    */
+    const T& threshold() const noexcept { return h.top(); }
+
+    void push(const T& value)
+    {
+        if (h.size() < k)
+            h.push(value);
+        else if (k && value > h.top())
+            h.replace_top(value);
+    }
+    void push(const T * first, long n);
+    /**
+    * push(first, n) with the array split among the workers of the shared
+    * task_scheduler. Each worker fills one selector of its own with all the
+    * pieces it runs, and those are merged into this one once all are done.
+    *
+    * grain: subarrays no longer than this are selected sequentially
+    */
+    void push_parallel(const T * first, long n, long grain = 1 << 16);
+    /**
+    * Push the values kept by s.
+    */
+    void merge(const top_k & s)
+    {
+        for (int i = 0; i < s.h.size(); ++i)
+            push(s.h[i]);
+    }
+    /**
+    * Move the values kept to out in descending order, leaving the selector
+    * empty.
+    */
+    void extract(T * out);
+};
+
+template <typename T, int D>
+void top_k<T, D>::push(const T * first, long n)
+{
+    long i = 0;
+    // fill the heap first, as there is no threshold before it is full
+    for (; i < n && h.size() < k; ++i)
+        h.push(first[i]);
+    if (!k)
+        return;
+
+    if constexpr (std::is_same<T, int>::value || std::is_same<T, float>::value) {
+#if defined(__AVX2__)
+        for (; i + 8 <= n; i += 8) {
+            unsigned mask;
+            if constexpr (std::is_same<T, int>::value)
+                mask = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(
+                    _mm256_loadu_si256(reinterpret_cast<const __m256i *>(first + i)),
+                    _mm256_set1_epi32(h.top()))));
+            else
+                mask = _mm256_movemask_ps(_mm256_cmp_ps(_mm256_loadu_ps(first + i),
+                    _mm256_set1_ps(h.top()), _CMP_GT_OQ));
+            // the threshold rises with every value admitted, so check again
+            for (; mask; mask &= mask - 1)
+                push(first[i + __builtin_ctz(mask)]);
+        }
+#elif defined(__SSE2__)
+        for (; i + 4 <= n; i += 4) {
+            unsigned mask;
+            if constexpr (std::is_same<T, int>::value)
+                mask = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpgt_epi32(
+                    _mm_loadu_si128(reinterpret_cast<const __m128i *>(first + i)),
+                    _mm_set1_epi32(h.top()))));
+            else
+                mask = _mm_movemask_ps(_mm_cmpgt_ps(_mm_loadu_ps(first + i),
+                    _mm_set1_ps(h.top())));
+            for (; mask; mask &= mask - 1)
+                push(first[i + __builtin_ctz(mask)]);
+        }
+#endif
+    }
+    for (; i < n; ++i)
+        push(first[i]);
+}
+
+template <typename T, int D>
+    template <typename Local>
+void top_k<T, D>::split(const T * first, long n, long grain, Local * locals)
+{
+    if (n <= grain) {
+        locals[task_scheduler::instance().worker_index()].s.push(first, n);
+        return;
+    }
+    task_scheduler::instance().fork_join(
+        [=] { split(first, n / 2, grain, locals); },
+        [=] { split(first + n / 2, n - n / 2, grain, locals); });
+}
+
+template <typename T, int D>
+void top_k<T, D>::push_parallel(const T * first, long n, long grain)
+{
+    if (n <= grain) {
+        push(first, n);
+        return;
+    }
+    // a cache line apart, so that workers do not write to the same line
+    struct alignas(64) local
+    {
+        top_k s;
+    };
+    task_scheduler & ts = task_scheduler::instance();
+    vector<local> locals(ts.size());
+    for (local & l : locals)
+        l.s.k = k;
+    // split runs on the workers even when called from outside the pool
+    ts.fork_join([=, &locals] { split(first, n / 2, grain, locals.begin()); },
+                 [=, &locals] { split(first + n / 2, n - n / 2, grain, locals.begin()); });
+    for (const local & l : locals)
+        merge(l.s);
+}
+
+template <typename T, int D>
+void top_k<T, D>::extract(T * out)
+{
+    // the heap pops in ascending order, so fill out from the back
+    for (int i = h.size() - 1; i >= 0; --i) {
+        out[i] = h.top();
+        h.pop();
+    }
+}
+
+}
+
+#endif // TOP_K_H_
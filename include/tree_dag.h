@@ -0,0 +1,370 @@
+#ifndef TREE_DAG_H_
+#define TREE_DAG_H_
+
+#include <cstddef>
+#include <functional>
+#include "vector.h"
+#include "stack.h"
+#include "chunked_array.h"
+#include "inorder_index.h"
+#include "linked_binary_tree.h"
+
+namespace sx
+{
+
+/**
+* A store of binary trees in which identical subtrees are kept once, for
+* many trees sharing much of their structure.
+*
+* Every subtree is hash-consed: a node is the triple (key, left, right) of
+* its key and the ids of its children, and an open-addressing table maps
+* each triple to the one id made for it. Trees added are thus built into a
+* DAG bottom-up, and two subtrees, in the same tree or not, are equal
+* exactly when their ids are. Id 0 is the empty tree.
+*
+* T needs operator== and std::hash<T>.
+*/
+template <typename T>
+class tree_dag
+{
+private:
+    typedef typename linked_binary_tree<T>::node node;
+
+    struct entry
+    {
+        T key;
+        int left, right, size;
+    };
+
+    // entries[id - 1] for id > 0
+    vector<entry> entries;
+    // ids by hash with linear probing, 0 for an empty slot, the size being a
+    // power of two at least twice the number of ids
+    int * slots;
+    int mask;
+
+    static std::size_t hash(const T& key, int left, int right) noexcept
+    {
+        unsigned long long h = std::hash<T>()(key);
+        h ^= (unsigned long long)left * 0x9e3779b97f4a7c15ULL;
+        h ^= (unsigned long long)right * 0xc2b2ae3d27d4eb4fULL;
+        // the finalizer of MurmurHash3, so that all bits take part in the mask
+        h ^= h >> 33;
+        h *= 0xff51afd7ed558ccdULL;
+        h ^= h >> 33;
+        h *= 0xc4ceb9fe1a85ec53ULL;
+        h ^= h >> 33;
+        return h;
+    }
+    void grow();
+    // add from a preorder and inorder walk, finding each root in its part
+    // [first, last) of the inorder walk by find(key, first, last)
+    template <typename RandomIt, typename Find>
+    int build(RandomIt preorder_first, RandomIt preorder_last, RandomIt inorder_first,
+              const Find & find);
+public:
+    class node_iterator_post
+    {
+    private:
+        struct frame
+        {
+            int id;
+            bool going_right;
+
+            frame(int id_) : id(id_), going_right(true) {}
+        };
+        const tree_dag * d;
+        stack<frame, chunked_array<frame>> s;
+
+        void find_first(int id);
+    public:
+        node_iterator_post(const tree_dag * d_, int root) : d(d_)
+        {
+            if (root)
+                find_first(root);
+        }
+
+        int operator*() const noexcept { return s.top().id; }
+        node_iterator_post & operator++();
+        bool operator==(const node_iterator_post & i) const noexcept
+        {
+            return s.empty() && i.s.empty();
+        }
+        bool operator!=(const node_iterator_post & i) const noexcept
+        {
+            return !(*this == i);
+        }
+    };
+
+    tree_dag();
+    tree_dag(const tree_dag &) = delete;
+    tree_dag & operator=(const tree_dag &) = delete;
+    ~tree_dag() { delete []slots; }
+
+    // number of distinct subtrees, i.e. nodes stored
+    int size() const noexcept { return entries.size(); }
+
+    /**
+    * return: the id of the tree with key at its root and the trees left and
+    * right as its subtrees, the same id for the same arguments
+    */
+    int make(const T& key, int left, int right);
+    /**
+    * Add the tree rooted at root, nullptr for an empty tree.
+    *
+    * return: the id of its root
+    */
+    int add(const node * root);
+    /**
+    * Add a tree given as arrays of children, as in the input of link_nodes.
+    *
+    * left, right: left[i] and right[i] are the children of the i-th node,
+    * numbered from 1, with 0 for no child
+    * key: key[i] is the key of the i-th node
+    * n: the number of nodes
+    */
+    int add(const int * left, const int * right, const T * key, int n);
+    /**
+    * Add a tree from its preorder and inorder walk, as in create_root. Keys
+    * are assumed distinct, each root being found through an inorder_index.
+    */
+    template <typename RandomIt>
+    int add(RandomIt preorder_first, RandomIt preorder_last, RandomIt inorder_first);
+
+    const T& key(int id) const noexcept { return entries[id - 1].key; }
+    int left(int id) const noexcept { return entries[id - 1].left; }
+    int right(int id) const noexcept { return entries[id - 1].right; }
+    // the number of nodes in the tree, counting shared ones every time
+    int subtree_size(int id) const noexcept { return id ? entries[id - 1].size : 0; }
+
+    node_iterator_post begin_post(int root) const { return node_iterator_post(this, root); }
+    node_iterator_post end_post() const { return node_iterator_post(this, 0); }
+
+    /**
+    * Expand the tree into nodes created with new, as from create_root.
+    */
+    node * to_linked(int root) const;
+};
+
+template <typename T>
+tree_dag<T>::tree_dag() : slots(new int [16]()), mask(15) {}
+
+template <typename T>
+void tree_dag<T>::grow()
+{
+    delete []slots;
+    mask = mask * 2 + 1;
+    slots = new int [mask + 1]();
+    for (int id = 1; id <= entries.size(); ++id) {
+        const entry & e = entries[id - 1];
+        std::size_t i = hash(e.key, e.left, e.right) & mask;
+        while (slots[i])
+            i = (i + 1) & mask;
+        slots[i] = id;
+    }
+}
+
+template <typename T>
+int tree_dag<T>::make(const T& key, int left, int right)
+{
+    std::size_t i = hash(key, left, right) & mask;
+    for (int id; (id = slots[i]); i = (i + 1) & mask) {
+        const entry & e = entries[id - 1];
+        if (e.left == left && e.right == right && e.key == key)
+            return id;
+    }
+    entries.push_back(entry {key, left, right,
+                             subtree_size(left) + subtree_size(right) + 1});
+    slots[i] = entries.size();
+    if (2 * entries.size() > mask)
+        grow();
+    return entries.size();
+}
+
+template <typename T>
+int tree_dag<T>::add(const node * root)
+{
+    // a postorder walk, the ids of finished subtrees waiting on a stack
+    // for their parent
+    struct frame
+    {
+        const node * n;
+        int state;
+    };
+    stack<frame, chunked_array<frame>> s;
+    stack<int, chunked_array<int>> ids;
+    if (!root)
+        return 0;
+    s.push(frame {root, 0});
+    while (!s.empty()) {
+        frame & f = s.top();
+        const node * c = f.state ? f.n->right : f.n->left;
+        if (f.state++ < 2) {
+            if (c)
+                s.push(frame {c, 0});
+            else
+                ids.push(0);
+            continue;
+        }
+        int r = ids.top();
+        ids.pop();
+        int l = ids.top();
+        ids.pop();
+        ids.push(make(f.n->key, l, r));
+        s.pop();
+    }
+    return ids.top();
+}
+
+template <typename T>
+int tree_dag<T>::add(const int * left, const int * right, const T * key, int n)
+{
+    if (!n)
+        return 0;
+    // the root is the only node that is no one's child
+    long long root = (long long)n * (n + 1) / 2;
+    for (int i = 0; i < n; ++i)
+        root -= left[i] + right[i];
+
+    struct frame
+    {
+        int v, state;
+    };
+    stack<frame, chunked_array<frame>> s;
+    stack<int, chunked_array<int>> ids;
+    s.push(frame {int(root), 0});
+    while (!s.empty()) {
+        frame & f = s.top();
+        int c = f.state ? right[f.v - 1] : left[f.v - 1];
+        if (f.state++ < 2) {
+            if (c)
+                s.push(frame {c, 0});
+            else
+                ids.push(0);
+            continue;
+        }
+        int r = ids.top();
+        ids.pop();
+        int l = ids.top();
+        ids.pop();
+        ids.push(make(key[f.v - 1], l, r));
+        s.pop();
+    }
+    return ids.top();
+}
+
+template <typename T>
+    template <typename RandomIt>
+int tree_dag<T>::add(RandomIt preorder_first, RandomIt preorder_last,
+                     RandomIt inorder_first)
+{
+    int n = preorder_last - preorder_first;
+    if (!n)
+        return 0;
+    inorder_index<RandomIt> find(inorder_first, n);
+    return build(preorder_first, preorder_last, inorder_first, find);
+}
+
+template <typename T>
+    template <typename RandomIt, typename Find>
+int tree_dag<T>::build(RandomIt preorder_first, RandomIt preorder_last,
+                       RandomIt inorder_first, const Find & find)
+{
+    // a postorder walk over the subtrees, each a part of both walks, as in
+    // add(left, right, key, n), so that a deep tree does not recurse
+    struct frame
+    {
+        RandomIt preorder_first, inorder_first;
+        int n, left_size, state;
+    };
+    stack<frame, chunked_array<frame>> s;
+    stack<int, chunked_array<int>> ids;
+    s.push(frame {preorder_first, inorder_first,
+                  int(preorder_last - preorder_first), 0, 0});
+    while (!s.empty()) {
+        frame & f = s.top();
+        if (!f.state) {
+            // find the position of the root in the inorder walk
+            f.left_size = find(*f.preorder_first, f.inorder_first,
+                               f.inorder_first + f.n) - f.inorder_first;
+            ++f.state;
+            if (f.left_size)
+                s.push(frame {f.preorder_first + 1, f.inorder_first,
+                              f.left_size, 0, 0});
+            else
+                ids.push(0);
+            continue;
+        }
+        if (f.state++ == 1) {
+            int right_size = f.n - f.left_size - 1;
+            if (right_size)
+                s.push(frame {f.preorder_first + f.left_size + 1,
+                              f.inorder_first + f.left_size + 1, right_size, 0, 0});
+            else
+                ids.push(0);
+            continue;
+        }
+        int r = ids.top();
+        ids.pop();
+        int l = ids.top();
+        ids.pop();
+        ids.push(make(*f.preorder_first, l, r));
+        s.pop();
+    }
+    return ids.top();
+}
+
+template <typename T>
+void tree_dag<T>::node_iterator_post::find_first(int id)
+{
+    while (true) {
+        s.push(id);
+        if (d->left(id))
+            id = d->left(id);
+        else if (d->right(id)) {
+            s.top().going_right = false;
+            id = d->right(id);
+        }
+        else
+            break;
+    }
+    s.top().going_right = false;
+}
+
+template <typename T>
+typename tree_dag<T>::node_iterator_post & tree_dag<T>::node_iterator_post::operator++()
+{
+    s.pop();
+    if (!s.empty() && s.top().going_right) {
+        s.top().going_right = false;
+        if (d->right(s.top().id))
+            find_first(d->right(s.top().id));
+    }
+    return *this;
+}
+
+template <typename T>
+typename tree_dag<T>::node * tree_dag<T>::to_linked(int root) const
+{
+    // a shared subtree is expanded once for every place it appears in
+    stack<node *, chunked_array<node *>> made;
+    for (auto i = begin_post(root); i != end_post(); ++i) {
+        node * n = new node(key(*i));
+        if (right(*i)) {
+            n->right = made.top();
+            n->right->p = n;
+            made.pop();
+        }
+        if (left(*i)) {
+            n->left = made.top();
+            n->left->p = n;
+            made.pop();
+        }
+        made.push(n);
+    }
+    return root ? made.top() : nullptr;
+}
+
+}
+
+#endif // TREE_DAG_H_
@@ -0,0 +1,23 @@
+#ifndef TREE_FREEZE_H_
+#define TREE_FREEZE_H_
+
+#include "linked_binary_tree.h"
+#include "static_search_tree.h"
+
+namespace sx
+{
+
+/**
+* Copy the keys of t into a static search tree for fast lookups, e.g.
+* freeze(t) for an eytzinger_tree or freeze<veb_tree>(t), assuming that t is
+* a binary search tree, i.e. its inorder walk is sorted.
+*/
+template <template <typename> class Tree = eytzinger_tree, typename T>
+Tree<T> freeze(const linked_binary_tree<T> & t)
+{
+    return Tree<T>(t.inorder_keys());
+}
+
+}
+
+#endif // TREE_FREEZE_H_
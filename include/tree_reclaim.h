@@ -0,0 +1,25 @@
+#ifndef TREE_RECLAIM_H_
+#define TREE_RECLAIM_H_
+
+#include "linked_binary_tree.h"
+#include "reclaimer.h"
+
+namespace sx
+{
+
+/**
+* linked_binary_tree<T>::erase(n) on the reclaimer thread, returning at once.
+* A heap tree t is freed so when destroyed after
+* t.erase_with(&erase_background<T>).
+*/
+template <typename T>
+void erase_background(typename linked_binary_tree<T>::node * n)
+{
+    reclaimer::instance().submit([](void * p) {
+        linked_binary_tree<T>::erase(static_cast<typename linked_binary_tree<T>::node *>(p));
+    }, n);
+}
+
+}
+
+#endif // TREE_RECLAIM_H_
@@ -0,0 +1,223 @@
+#ifndef UNROLLED_FORWARD_LIST_H_
+#define UNROLLED_FORWARD_LIST_H_
+
+#include <new>
+#include <utility>
+
+namespace sx
+{
+
+/**
+* A linked list storing up to B elements per node in an inline array, so that
+* walking the list touches one node per B elements instead of one per element.
+*
+* Elements are pushed at the back and may be popped from either end, which
+* makes the list usable as the container of both queue and stack.
+*/
+template <typename T, int B = 64>
+class unrolled_forward_list
+{
+    static_assert(B > 0, "a node must hold at least one element");
+private:
+    struct node
+    {
+        // raw storage so that T need not be default constructible
+        alignas(T) unsigned char buffer[B * sizeof(T)];
+        node * prev, * next;
+
+        T * keys() noexcept { return reinterpret_cast<T *>(buffer); }
+        const T * keys() const noexcept
+        {
+            return reinterpret_cast<const T *>(buffer);
+        }
+    };
+    int var_size;
+    node * head, * tail;
+    // [first, last) are the occupied slots of head and tail respectively
+    int first, last;
+    // An emptied node is kept here instead of being deleted, so that pushing
+    // and popping across a node boundary does not hit the allocator.
+    node * spare;
+
+    node * new_node();
+    void delete_node(node * n) noexcept;
+public:
+    class const_iterator
+    {
+    private:
+        const node * p;
+        int i;
+        const node * tail;
+        int last;
+    public:
+        const_iterator() = default;
+        const_iterator(const node * p_, int i_, const node * tail_, int last_) noexcept
+            : p(p_), i(i_), tail(tail_), last(last_) {}
+
+        const_iterator operator++() noexcept
+        {
+            // move to the next node at the end of the inline array, unless
+            // this is the tail, where past-the-end is (tail, last)
+            if (++i == B && p != tail) {
+                p = p->next;
+                i = 0;
+            }
+            return *this;
+        }
+        const_iterator operator++(int) noexcept
+        {
+            const_iterator temp = *this;
+            ++*this;
+            return temp;
+        }
+        const T & operator*() const noexcept { return p->keys()[i]; }
+        bool operator==(const const_iterator & it) const noexcept
+        {
+            return p == it.p && i == it.i;
+        }
+        bool operator!=(const const_iterator & it) const noexcept
+        {
+            return !(*this == it);
+        }
+    };
+
+    unrolled_forward_list() noexcept
+        : var_size(0), head(nullptr), tail(nullptr), first(0), last(0),
+        spare(nullptr) {}
+    unrolled_forward_list(const unrolled_forward_list & l);
+    unrolled_forward_list & operator=(const unrolled_forward_list &) = delete;
+    ~unrolled_forward_list();
+
+    const_iterator begin() const noexcept
+    {
+        return const_iterator(head, first, tail, last);
+    }
+    const_iterator end() const noexcept
+    {
+        return const_iterator(tail, last, tail, last);
+    }
+
+    int size() const noexcept { return var_size; }
+    bool empty() const noexcept { return !var_size; }
+    T& front() noexcept { return head->keys()[first]; }
+    const T& front() const noexcept { return head->keys()[first]; }
+    T& back() noexcept { return tail->keys()[last - 1]; }
+    const T& back() const noexcept { return tail->keys()[last - 1]; }
+    void push_back(const T& value);
+    void push_back(T&& value);
+    void pop_front();
+    void pop_back();
+};
+
+template <typename T, int B>
+inline typename unrolled_forward_list<T, B>::node *
+unrolled_forward_list<T, B>::new_node()
+{
+    node * n;
+    if (spare) {
+        n = spare;
+        spare = nullptr;
+    }
+    else
+        n = new node;
+    n->prev = n->next = nullptr;
+    return n;
+}
+
+template <typename T, int B>
+inline void unrolled_forward_list<T, B>::delete_node(node * n) noexcept
+{
+    if (spare)
+        delete n;
+    else
+        spare = n;
+}
+
+template <typename T, int B>
+unrolled_forward_list<T, B>::unrolled_forward_list(const unrolled_forward_list & l)
+    : unrolled_forward_list()
+{
+    for (const_iterator i = l.begin(); i != l.end(); ++i)
+        push_back(*i);
+}
+
+template <typename T, int B>
+unrolled_forward_list<T, B>::~unrolled_forward_list()
+{
+    while (!empty())
+        pop_front();
+    delete spare;
+}
+
+template <typename T, int B>
+void unrolled_forward_list<T, B>::push_back(const T& value)
+{
+    T temp(value);
+    push_back(std::move(temp));
+}
+
+template <typename T, int B>
+void unrolled_forward_list<T, B>::push_back(T&& value)
+{
+    if (empty()) {
+        head = tail = new_node();
+        first = last = 0;
+    }
+    else if (last == B) {
+        node * n = new_node();
+        n->prev = tail;
+        tail = tail->next = n;
+        last = 0;
+    }
+    new (tail->keys() + last) T(std::move(value));
+    ++last;
+    ++var_size;
+}
+
+template <typename T, int B>
+void unrolled_forward_list<T, B>::pop_front()
+{
+    // assume list non-empty
+    head->keys()[first].~T();
+    ++first;
+    --var_size;
+    if (head == tail) {
+        if (first == last) {
+            delete_node(head);
+            head = tail = nullptr;
+        }
+    }
+    else if (first == B) {
+        node * temp = head;
+        head = head->next;
+        head->prev = nullptr;
+        first = 0;
+        delete_node(temp);
+    }
+}
+
+template <typename T, int B>
+void unrolled_forward_list<T, B>::pop_back()
+{
+    // assume list non-empty
+    --last;
+    tail->keys()[last].~T();
+    --var_size;
+    if (head == tail) {
+        if (first == last) {
+            delete_node(tail);
+            head = tail = nullptr;
+        }
+    }
+    else if (last == 0) {
+        node * temp = tail;
+        tail = tail->prev;
+        tail->next = nullptr;
+        last = B;
+        delete_node(temp);
+    }
+}
+
+}
+
+#endif // UNROLLED_FORWARD_LIST_H_
@@ -52,6 +52,8 @@ public:
     void push_back(const T& value);
     void push_back(T&& value);
     void pop_front() { erase(begin()); }
+    void pop_back() noexcept { --var_size; }
+    void clear() noexcept { var_size = 0; }
 
     const T & operator[](int i) const noexcept { return data[i]; }
     T & operator[](int i) noexcept { return data[i]; }
@@ -109,7 +111,7 @@ const vector<T> & vector<T>::operator=(const vector & v)
     if (this == &v)
         return *this;
     delete []data;
-    v.var_size = v.var_capacity = v.var_size;
+    var_size = var_capacity = v.var_size;
     if (var_size) {
         data = new T [var_size];
         for (int i = 0; i < var_size; ++i)
@@ -126,7 +128,8 @@ const vector<T> & vector<T>::operator=(vector && v) noexcept
     if (this == &v)
         return *this;
     delete []data;
-    v.var_size = v.var_capacity = v.var_size;
+    var_size = v.var_size;
+    var_capacity = v.var_capacity;
     data = v.data;
     v.data = nullptr;
     return *this;
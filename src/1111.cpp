@@ -1,4 +1,5 @@
 #include <iostream>
+#include <cstdio>
 #include <cstring>
 
 template <typename T>
@@ -102,6 +103,43 @@ public:
     void pop() { c.pop_front(); }
 };
 
+/**
+* Buffered output to stdout, flushed when full and on destruction.
+*/
+class writer
+{
+private:
+    static const int BUFFER_SIZE = 1 << 16;
+    char buffer[BUFFER_SIZE];
+    int len;
+public:
+    writer() noexcept : len(0) {}
+    ~writer() { flush(); }
+
+    void flush()
+    {
+        std::fwrite(buffer, 1, len, stdout);
+        len = 0;
+    }
+    writer & operator<<(char c)
+    {
+        if (len == BUFFER_SIZE)
+            flush();
+        buffer[len++] = c;
+        return *this;
+    }
+    writer & operator<<(const char * s)
+    {
+        // assume s shorter than the buffer
+        int n = std::strlen(s);
+        if (len + n > BUFFER_SIZE)
+            flush();
+        std::memcpy(buffer + len, s, n);
+        len += n;
+        return *this;
+    }
+};
+
 template <typename T>
 class binary_tree
 {
@@ -111,7 +149,9 @@ public:
     private:
         T key;
         node * left, * right;
-        int pos;    // position of the node in level walking the tree
+        // position of the node in level walking the tree, children of
+        // position i at 2i + 1 and 2i + 2
+        unsigned long long pos;
         node(const T& key_, node * left_ = nullptr, node * right_ = nullptr) noexcept
             : key(key_), left(left_), right(right_) {}
 
@@ -129,7 +169,11 @@ public:
     static node * create_root(RandomIt preorder_first, RandomIt preorder_last,
                               RandomIt inorder_first);
 
-    void print(int tree_size) const;
+    /**
+    * Print the keys in level order, with a NULL for every missing node
+    * before the last one.
+    */
+    void print(writer & out) const;
 };
 
 /**
@@ -170,20 +214,23 @@ typename binary_tree<T>::node * binary_tree<T>::create_root(
 }
 
 template <typename T>
-void binary_tree<T>::print(int tree_size) const
+void binary_tree<T>::print(writer & out) const
 {
+    // A level walk visits nodes in increasing position, so the NULLs before
+    // a node are just the gap to the position of the last node printed.
+    // Nothing but the queue is kept, however sparse the tree is.
     queue<const node *> q;
-    const node * output[1000];
-    for (int i = 0; i < 1000; ++i)
-        output[0] = nullptr;
-
     root->pos = 0;
     q.push(root);
     const node * n;
+    unsigned long long next = 0;
     while (!q.empty()) {
         n = q.front();
         q.pop();
-        output[n->pos] = n;
+        for (; next < n->pos; ++next)
+            out << "NULL ";
+        out << n->key;
+        ++next;
         if (n->left) {
             n->left->pos = 2 * n->pos + 1;
             q.push(n->left);
@@ -192,20 +239,10 @@ void binary_tree<T>::print(int tree_size) const
             n->right->pos = 2 * n->pos + 2;
             q.push(n->right);
         }
+        if (!q.empty())
+            out << ' ';
     }
-
-    int n_node_printed = 0;
-    for (int i = 0; n_node_printed < tree_size; ++i) {
-        if (output[i]) {
-            std::cout << output[i]->key;
-            ++n_node_printed;
-        }
-        else
-            std::cout << "NULL";
-        if (n_node_printed != tree_size)
-            std::cout.put(' ');
-    }
-    std::cout.put('\n');
+    out << '\n';
 }
 
 int main()
@@ -214,6 +251,7 @@ int main()
     std::cin >> preorder >> inorder;
     int tree_size = std::strlen(preorder);
     binary_tree<char> t(preorder, preorder + tree_size, inorder);
-    t.print(tree_size);
+    writer out;
+    t.print(out);
     return 0;
 }
@@ -1,129 +1,50 @@
 #include <iostream>
 
-template <typename T>
-class forward_list
+/**
+* Check whether the tree given as arrays of children is complete.
+*
+* left, right: left[i] and right[i] are the children of the i-th node,
+* numbered from 1, with 0 for no child
+* n: the number of nodes
+*/
+bool complete(const int * left, const int * right, int n)
 {
-private:
-    struct node
-    {
-        T key;
-        node * next;
-    };
-    int var_size;
-    node * head, * tail;
-public:
-    forward_list() noexcept : var_size(0), head(nullptr), tail(nullptr) {}
-    ~forward_list();
-
-    bool empty() const noexcept { return !var_size; }
-    T& front() noexcept { return head->key; }
-    const T& front() const noexcept { return head->key; }
-    void push_back(const T& value);
-    void push_back(T&& value);
-    void pop_front();
-};
-
-template <typename T>
-forward_list<T>::~forward_list()
-{
-    node * temp;
-    while (head) {
-        temp = head;
-        head = head->next;
-        delete temp;
-    }
-}
-
-template <typename T>
-void forward_list<T>::push_back(const T& value)
-{
-    if (head)
-        tail = tail->next = new node {value, nullptr};
-    else
-        head = tail = new node {value, nullptr};
-    ++var_size;
-}
-
-template <typename T>
-void forward_list<T>::push_back(T&& value)
-{
-    if (head)
-        tail = tail->next = new node {value, nullptr};
-    else
-        head = tail = new node {value, nullptr};
-    ++var_size;
-}
-
-template <typename T>
-void forward_list<T>::pop_front()
-{
-    // assume list non-empty
-    node * temp = head;
-    if (head == tail)
-        head = nullptr;
-    else
-        head = head->next;
-    delete temp;
-    --var_size;
-}
-
-template <typename T, typename Container = forward_list<T>>
-class queue
-{
-protected:
-    Container c;
-public:
-    T& front() { return c.front(); }
-    const T& front() const { return c.front(); }
-    bool empty() const { return c.empty(); }
-    void push(const T& value) { c.push_back(value); }
-    void push(T&& value) { c.push_back(value); }
-    void pop() { c.pop_front(); }
-};
-
-class linked_binary_tree
-{
-public:
-    struct node
-    {
-        node * p, * left, * right;
-
-        node() noexcept : p(nullptr), left(nullptr), right(nullptr) {}
-
-        int degree() const noexcept { return bool(left) + bool(right); }
-    };
-private:
-    node * root;
-public:
-    linked_binary_tree(node * root_) noexcept : root(root_) {}
-
-    bool complete() const;
-};
-
-bool linked_binary_tree::complete() const
-{
-    queue<const node *> q;
-    bool no_leaf_node = true;
-    q.push(root);
-
-    const node * n;
-    while (!q.empty()) {
-        n = q.front();
-        q.pop();
-        // The case where a node only has a right children has been checked at
-        // initialization.
-        if (no_leaf_node) {
-            if (n->degree() < 2)
-                no_leaf_node = false;
+    if (!n)
+        return true;
+    // the root is the only node that is no one's child
+    long long root = (long long)n * (n + 1) / 2;
+    for (int i = 0; i < n; ++i)
+        root -= left[i] + right[i];
+
+    // Number the nodes heap-style, children of position i at 2i + 1 and
+    // 2i + 2. The tree is complete if and only if the n nodes take exactly
+    // positions 0 to n - 1, so every position must be taken when reached in
+    // order.
+    int * at = new int [n]();
+    at[0] = int(root);
+    bool is_complete = true;
+    for (int i = 0, v; i < n; ++i) {
+        if (!(v = at[i])) {
+            is_complete = false;
+            break;
+        }
+        if (left[v - 1]) {
+            if (2LL * i + 1 >= n) {
+                is_complete = false;
+                break;
+            }
+            at[2 * i + 1] = left[v - 1];
+        }
+        if (right[v - 1]) {
+            if (2LL * i + 2 >= n) {
+                is_complete = false;
+                break;
+            }
+            at[2 * i + 2] = right[v - 1];
         }
-        else if (n->degree())
-            return false;
-        if (n->left)
-            q.push(n->left);
-        if (n->right)
-            q.push(n->right);
     }
-    return true;
+    delete []at;
+    return is_complete;
 }
 
 int main()
@@ -131,34 +52,13 @@ int main()
     std::ios_base::sync_with_stdio(false);
     int tree_size;
     std::cin >> tree_size;
-    linked_binary_tree::node nodes[tree_size];
-    bool is_cbt = true;
-
-    int left, right;
-    for (int i = 0; i < tree_size; ++i) {
-        std::cin >> left >> right;
-        if (left == 0 && right) {
-            is_cbt = false;
-            break;
-        }
-        if (left) {
-            nodes[i].left = &nodes[left - 1];
-            nodes[left - 1].p = &nodes[i];
-        }
-        if (right) {
-            nodes[i].right = &nodes[right - 1];
-            nodes[right - 1].p = &nodes[i];
-        }
-    }
+    int * left = new int [tree_size], * right = new int [tree_size];
 
-    if (is_cbt) {
-        linked_binary_tree::node * root;
-        // find the root
-        for (root = &nodes[tree_size - 1]; root->p; root = root->p);
-        linked_binary_tree t(root);
-        is_cbt = t.complete();
-    }
-    std::cout.put(is_cbt ? 'Y' : 'N');
+    for (int i = 0; i < tree_size; ++i)
+        std::cin >> left[i] >> right[i];
+    std::cout.put(complete(left, right, tree_size) ? 'Y' : 'N');
 
+    delete []left;
+    delete []right;
     return 0;
 }
@@ -0,0 +1,233 @@
+/**
+* Batch mode of 1211: check a stream of trees for completeness.
+*
+* The input is any number of records in the format of 1211, each a line
+* <n> followed by n lines <left> <right>. One line Y or N per record is
+* written to standard output in input order.
+*
+* The main thread parses records into batches and hands them to worker
+* threads through an mpmc_queue. A fixed ring of batches is reused, so their
+* buffers stop growing after the first few, and each worker keeps one scratch
+* buffer for all its trees. Results are written as soon as the oldest batch is
+* done, which keeps output in order with WINDOW_PER_THREAD batches per worker
+* in flight.
+*
+* Throughput and a histogram of the time to check each tree go to standard
+* error.
+*
+* usage: 1211_batch [threads] < trees
+* build: g++ -std=c++17 -O2 -pthread -Iinclude src/1211_batch.cpp
+*/
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <thread>
+#include "vector.h"
+#include "mpmc_queue.h"
+#include "linked_binary_tree.h"
+
+namespace
+{
+
+const int BATCH_TREES = 1024;
+// batches per worker in flight
+const int WINDOW_PER_THREAD = 4;
+// histogram buckets by the highest bit of the nanoseconds taken
+const int N_BUCKETS = 32;
+
+typedef std::chrono::steady_clock steady;
+
+class reader
+{
+private:
+    static const int BUFFER_SIZE = 1 << 16;
+    char buffer[BUFFER_SIZE];
+    int pos, len;
+
+    int get()
+    {
+        if (pos == len) {
+            len = int(std::fread(buffer, 1, BUFFER_SIZE, stdin));
+            pos = 0;
+            if (len <= 0)
+                return EOF;
+        }
+        return buffer[pos++];
+    }
+public:
+    reader() noexcept : pos(0), len(0) {}
+
+    /**
+    * Read a non-negative integer into x.
+    *
+    * return: false at the end of input
+    */
+    bool read(int & x)
+    {
+        int c;
+        while ((c = get()) != EOF && (c < '0' || c > '9'));
+        if (c == EOF)
+            return false;
+        x = 0;
+        do
+            x = x * 10 + (c - '0');
+        while ((c = get()) >= '0' && c <= '9');
+        return true;
+    }
+};
+
+struct batch
+{
+    // children of all trees in the batch back to back, tree i starting at
+    // first[i] and ending at first[i + 1]
+    sx::vector<int> left, right, first;
+    sx::vector<char> result;
+    std::atomic<bool> done;
+
+    batch() : done(false) {}
+
+    int size() const noexcept { return first.size() - 1; }
+
+    /**
+    * Read up to max_trees trees from in, replacing the trees held.
+    *
+    * return: false if the input ended
+    */
+    bool fill(reader & in, int max_trees)
+    {
+        left.clear();
+        right.clear();
+        first.clear();
+        first.push_back(0);
+        int n, l, r;
+        for (int i = 0; i < max_trees; ++i) {
+            if (!in.read(n))
+                return false;
+            for (int j = 0; j < n; ++j) {
+                if (!in.read(l) || !in.read(r)) {
+                    // drop the truncated tree
+                    while (left.size() > first.back()) {
+                        left.pop_back();
+                        right.pop_back();
+                    }
+                    return false;
+                }
+                left.push_back(l);
+                right.push_back(r);
+            }
+            first.push_back(left.size());
+        }
+        return true;
+    }
+};
+
+struct worker
+{
+    std::thread t;
+    // scratch space for complete, sized for the largest tree so far
+    int * at = nullptr;
+    int capacity = 0;
+    unsigned long long histogram[N_BUCKETS] = {};
+
+    ~worker() { delete []at; }
+
+    void process(batch & b)
+    {
+        b.result.clear();
+        for (int i = 0; i < b.size(); ++i) {
+            int n = b.first[i + 1] - b.first[i];
+            if (n > capacity) {
+                delete []at;
+                capacity = n > 2 * capacity ? n : 2 * capacity;
+                at = new int [capacity];
+            }
+            auto start = steady::now();
+            bool is_cbt = sx::linked_binary_tree<int>::complete(
+                &b.left[0] + b.first[i], &b.right[0] + b.first[i], n, at);
+            long long ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                steady::now() - start).count();
+            int bucket = ns > 0 ? 63 - __builtin_clzll(ns) : 0;
+            ++histogram[bucket < N_BUCKETS ? bucket : N_BUCKETS - 1];
+            b.result.push_back(is_cbt ? 'Y' : 'N');
+            b.result.push_back('\n');
+        }
+        b.done.store(true, std::memory_order_release);
+    }
+    void run(sx::mpmc_queue<batch *> & work)
+    {
+        batch * b;
+        // a null batch tells the worker to stop
+        while (work.pop(b), b)
+            process(*b);
+    }
+};
+
+void write_out(batch & b)
+{
+    while (!b.done.load(std::memory_order_acquire))
+        std::this_thread::yield();
+    std::fwrite(&b.result[0], 1, b.result.size(), stdout);
+}
+
+}
+
+int main(int argc, char * argv[])
+{
+    int n_threads = argc > 1 ? std::atoi(argv[1])
+        : int(std::thread::hardware_concurrency());
+    if (n_threads < 1)
+        n_threads = 1;
+    const int window = WINDOW_PER_THREAD * n_threads;
+
+    reader * in = new reader;
+    batch * ring = new batch [window];
+    worker * workers = new worker [n_threads];
+    sx::mpmc_queue<batch *> work(window + n_threads);
+    for (int i = 0; i < n_threads; ++i)
+        workers[i].t = std::thread(&worker::run, &workers[i], std::ref(work));
+
+    auto start = steady::now();
+    long long submitted = 0, written = 0, n_trees = 0;
+    bool more = true;
+    while (more) {
+        batch & b = ring[submitted % window];
+        // the batch to refill is the oldest, so its results go out first
+        if (submitted - written == window)
+            write_out(ring[written++ % window]);
+        more = b.fill(*in, BATCH_TREES);
+        if (!b.size())
+            break;
+        n_trees += b.size();
+        b.done.store(false, std::memory_order_relaxed);
+        work.push(&b);
+        ++submitted;
+    }
+    while (written < submitted)
+        write_out(ring[written++ % window]);
+    std::fflush(stdout);
+    std::chrono::duration<double> elapsed = steady::now() - start;
+
+    for (int i = 0; i < n_threads; ++i)
+        work.push(nullptr);
+    unsigned long long histogram[N_BUCKETS] = {};
+    for (int i = 0; i < n_threads; ++i) {
+        workers[i].t.join();
+        for (int j = 0; j < N_BUCKETS; ++j)
+            histogram[j] += workers[i].histogram[j];
+    }
+
+    std::cerr << n_trees << " trees in " << elapsed.count() << " s, "
+        << n_trees / elapsed.count() << " trees/s with " << n_threads
+        << " threads\nns per tree\tcount\n";
+    for (int j = 0; j < N_BUCKETS; ++j)
+        if (histogram[j])
+            std::cerr << '[' << (1ULL << j) << ", " << (2ULL << j) << ")\t"
+                << histogram[j] << '\n';
+
+    delete []workers;
+    delete []ring;
+    delete in;
+    return 0;
+}
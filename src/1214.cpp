@@ -106,97 +106,94 @@ public:
 };
 
 template <typename T>
-class rforward_list
+class chunked_array
 {
 private:
-    struct node
+    struct chunk
     {
-        T data;
-        node * next;
+        T * data;
+        int capacity;
+        chunk * prev, * next;
     };
+    static const int MIN_CAPACITY = 16;
+
     int var_size;
-    node * tail;
+    chunk * head, * cur;
+    // number of elements in the chunk cur
+    int top;
 public:
-    class const_iterator
-    {
-    private:
-        const node * p;
-    public:
-        const_iterator() = default;
-        const_iterator(const node * p_) noexcept : p(p_) {}
-
-        const_iterator operator++() noexcept { return p = p->next; }
-        const_iterator operator++(int) noexcept
-        {
-            node * temp = p;
-            p = p->next;
-            return temp;
-        }
-        const T & operator*() const noexcept { return p->data; }
-    };
-
-    rforward_list() noexcept : var_size(0), tail(nullptr) {}
-    ~rforward_list();
+    chunked_array() noexcept : var_size(0), head(nullptr), cur(nullptr), top(0) {}
+    chunked_array(const chunked_array & a);
+    chunked_array & operator=(const chunked_array &) = delete;
+    ~chunked_array();
 
     int size() const noexcept { return var_size; }
     bool empty() const noexcept { return !var_size; }
-    T& back() noexcept { return tail->data; }
-    const T& back() const noexcept { return tail->data; }
+    T& back() noexcept { return cur->data[top - 1]; }
+    const T& back() const noexcept { return cur->data[top - 1]; }
     void push_back(const T& value);
-    void push_back(T&& value);
     void pop_back();
 };
 
 template <typename T>
-rforward_list<T>::~rforward_list()
+chunked_array<T>::chunked_array(const chunked_array & a) : chunked_array()
 {
-    node * temp;
-    while (tail)
-    {
-        temp = tail;
-        tail = tail->next;
-        delete temp;
+    if (a.empty())
+        return;
+    for (const chunk * c = a.head; ; c = c->next) {
+        int n = c == a.cur ? a.top : c->capacity;
+        for (int i = 0; i < n; ++i)
+            push_back(c->data[i]);
+        if (c == a.cur)
+            break;
     }
 }
 
 template <typename T>
-void rforward_list<T>::push_back(const T& value)
+chunked_array<T>::~chunked_array()
 {
-    if (empty())
-        tail = new node {value, nullptr};
-    else
-        tail = new node {value, tail};
-    ++var_size;
+    chunk * temp;
+    while (head) {
+        temp = head;
+        head = head->next;
+        delete []temp->data;
+        delete temp;
+    }
 }
 
 template <typename T>
-void rforward_list<T>::push_back(T&& value)
+void chunked_array<T>::push_back(const T& value)
 {
-    if (empty())
-        tail = new node {value, nullptr};
-    else
-        tail = new node {value, tail};
+    if (!cur) {
+        head = cur = new chunk {new T [MIN_CAPACITY], MIN_CAPACITY, nullptr, nullptr};
+        top = 0;
+    }
+    else if (top == cur->capacity) {
+        // reuse a chunk kept from earlier pops or grow geometrically
+        if (!cur->next)
+            cur->next = new chunk {new T [2 * cur->capacity], 2 * cur->capacity, cur, nullptr};
+        cur = cur->next;
+        top = 0;
+    }
+    cur->data[top++] = value;
     ++var_size;
 }
 
 template <typename T>
-void rforward_list<T>::pop_back()
+void chunked_array<T>::pop_back()
 {
     if (!empty()) {
-        if (tail->next) {
-            node * temp = tail;
-            tail = tail->next;
-            delete temp;
-        }
-        else {
-            delete tail;
-            tail = nullptr;  // must be set to the null pointer
-        }
+        --top;
         --var_size;
+        // step back to the previous chunk but keep the current one
+        if (top == 0 && cur->prev) {
+            cur = cur->prev;
+            top = cur->capacity;
+        }
     }
 }
 
-template <typename T, typename Container = rforward_list<T>>
+template <typename T, typename Container = chunked_array<T>>
 class stack
 {
 public:
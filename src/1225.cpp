@@ -1,44 +1,78 @@
 #include <iostream>
+#include <emmintrin.h>
 
-template <typename RandomIt>
-void quick_sort(RandomIt first, RandomIt last)
+/**
+* An insert-only set of ints, the open-addressing table of sx::hash_set cut
+* down: one control byte per slot, EMPTY or 7 bits of the hash, matched 16
+* at a time with SSE2.
+*/
+class int_set
 {
-    if (first < last) {
-        auto p = *(last - 1);
-        RandomIt i = first;
-        decltype(p) temp;
-        
-        for (RandomIt j = first; j < last - 1; ++j)
-            if (*j <= p) {
-                // swap i and j
-                temp = *i;
-                *i = *j;
-                *j = temp;
-                ++i;
+private:
+    static const signed char EMPTY = -128;
+
+    signed char * raw, * ctrl;
+    int * slots;
+    int mask;
+
+    static unsigned match(const signed char * c, signed char h2)
+    {
+        __m128i g = _mm_load_si128(reinterpret_cast<const __m128i *>(c));
+        return _mm_movemask_epi8(_mm_cmpeq_epi8(g, _mm_set1_epi8(h2)));
+    }
+public:
+    // n: the most ints ever inserted
+    int_set(int n)
+    {
+        int capacity = 16;
+        while (capacity - capacity / 8 < n)
+            capacity *= 2;
+        mask = capacity / 16 - 1;
+        raw = new signed char [capacity + 15];
+        ctrl = raw + (16 - reinterpret_cast<unsigned long>(raw) % 16) % 16;
+        for (int i = 0; i < capacity; ++i)
+            ctrl[i] = EMPTY;
+        slots = new int [capacity];
+    }
+    ~int_set()
+    {
+        delete []raw;
+        delete []slots;
+    }
+
+    // return: false if key was already in
+    bool insert(int key)
+    {
+        unsigned long long h = (unsigned)key * 0x9e3779b97f4a7c15ULL;
+        h ^= h >> 32;
+        signed char h2 = h >> 57;
+        for (unsigned long g = h & mask, step = 1; ; g = (g + step++) & mask) {
+            const signed char * c = ctrl + g * 16;
+            for (unsigned m = match(c, h2); m; m &= m - 1)
+                if (slots[g * 16 + __builtin_ctz(m)] == key)
+                    return false;
+            if (unsigned m = match(c, EMPTY)) {
+                int i = g * 16 + __builtin_ctz(m);
+                ctrl[i] = h2;
+                slots[i] = key;
+                return true;
             }
-        *(last - 1) = *i;
-        *i = p;
-        
-        quick_sort(first, i);
-        quick_sort(i + 1, last);
+        }
     }
-}
+};
 
 int main()
 {
     std::ios_base::sync_with_stdio(false);
 
-    int n;
+    int n, a;
     std::cin >> n;
-    int a[n];
-    for (int i = 0; i < n; ++i)
-        std::cin >> a[i];
-
-    quick_sort(a, a + n);
-    int count = 1;
-    for (int i = 1, prev = a[0]; i < n; prev = a[i], ++i)
-        if (prev != a[i])
-            ++count;
+    int_set s(n);
+    int count = 0;
+    for (int i = 0; i < n; ++i) {
+        std::cin >> a;
+        count += s.insert(a);
+    }
     std::cout << count << std::endl;
 
     return 0;
@@ -0,0 +1,27 @@
+#include <iostream>
+#include "fenwick_tree.h"
+
+int main()
+{
+    std::ios_base::sync_with_stdio(false);
+
+    int n, m, k;
+    std::cin >> n >> m >> k;
+    // a 1 for everyone still in the circle
+    sx::vector<int> in;
+    for (int i = 0; i < n; ++i)
+        in.push_back(1);
+    sx::fenwick_tree<int> circle(in);
+
+    // As with the order statistic tree, the person counted from goes at
+    // index i among those left, and the m-th one is m - 1 places on. select
+    // finds where that index is in the original circle.
+    int i = 0, size = n;
+    for (int j = 1; j < k; ++j) {
+        i = (i + m - 1) % size--;
+        circle.add(circle.select(i), -1);
+    }
+    std::cout << circle.select((i + m - 1) % size) + 1;
+
+    return 0;
+}
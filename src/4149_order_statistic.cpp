@@ -0,0 +1,27 @@
+#include <iostream>
+#include "avl_tree.h"
+
+int main()
+{
+    std::ios_base::sync_with_stdio(false);
+
+    int n, m, k;
+    std::cin >> n >> m >> k;
+    int * people = new int [n];
+    for (int i = 0; i < n; ++i)
+        people[i] = i + 1;
+    sx::avl_tree<int> circle(people, people + n);
+    delete []people;
+
+    // The person counted from goes at index i in the order of the circle, so
+    // the m-th one is m - 1 places on, wrapping around. Once they are out,
+    // the next one takes their index.
+    int i = 0;
+    for (int j = 1; j < k; ++j) {
+        i = (i + m - 1) % circle.size();
+        circle.erase_at(i);
+    }
+    std::cout << circle.select((i + m - 1) % circle.size());
+
+    return 0;
+}